@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/vaddr.h"
 
 /* The code in this file is an interface to an ATA (IDE)
    controller.  It attempts to comply to [ATA-3]. */
@@ -48,6 +49,12 @@
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
 
+/* Largest sector count one READ/WRITE SECTOR command can carry. */
+#define MAX_SECTORS_PER_CMD 256
+
+/* Sectors in one page, for disk_read_pages() and disk_write_pages(). */
+#define SECTORS_PER_PAGE (PGSIZE / DISK_SECTOR_SIZE)
+
 /* An ATA device. */
 struct disk {
 	char name[8];               /* Name, e.g. "hd0:1". */
@@ -84,7 +91,7 @@ static void reset_channel (struct channel *);
 static bool check_device_type (struct disk *);
 static void identify_ata_device (struct disk *);
 
-static void select_sector (struct disk *, disk_sector_t);
+static void select_sector (struct disk *, disk_sector_t, size_t cnt);
 static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
@@ -214,7 +221,7 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
+	select_sector (d, sec_no, 1);
 	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
 	sema_down (&c->completion_wait);
 	if (!wait_while_busy (d))
@@ -236,7 +243,7 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
+	select_sector (d, sec_no, 1);
 	issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
@@ -246,6 +253,82 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	lock_release (&c->lock);
 }
 
+/* PAGES[]의 IDX번째 섹터 버퍼. 각 PAGES[i]는 PGSIZE 바이트 */
+static uint8_t *
+page_sector (void *const pages[], size_t idx) {
+	return (uint8_t *) pages[idx / SECTORS_PER_PAGE]
+		+ (idx % SECTORS_PER_PAGE) * DISK_SECTOR_SIZE;
+}
+
+/* 디스크 d의 SEC_NO부터 연속된 PAGE_CNT 페이지 분량의 섹터를 PAGES[0..PAGE_CNT-1]로 읽는다.
+ * 섹터마다 명령을 내리는 disk_read와 달리 최대 MAX_SECTORS_PER_CMD 섹터를
+ * READ SECTOR 명령 하나로 옮기고, 페이지 버퍼끼리는 연속일 필요가 없다. */
+void
+disk_read_pages (struct disk *d, disk_sector_t sec_no, void *const pages[],
+		size_t page_cnt) {
+	struct channel *c;
+	size_t total = page_cnt * SECTORS_PER_PAGE;
+	size_t done = 0;
+
+	ASSERT (d != NULL);
+	ASSERT (pages != NULL);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	while (done < total) {
+		size_t cnt = total - done;
+		if (cnt > MAX_SECTORS_PER_CMD)
+			cnt = MAX_SECTORS_PER_CMD;
+
+		select_sector (d, sec_no + done, cnt);
+		issue_pio_command (c, CMD_READ_SECTOR_RETRY);
+		for (size_t i = 0; i < cnt; i++, done++) {
+			/* 섹터 하나가 준비될 때마다 인터럽트가 온다. */
+			sema_down (&c->completion_wait);
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name,
+						(disk_sector_t) (sec_no + done));
+			input_sector (c, page_sector (pages, done));
+		}
+		d->read_cnt += cnt;
+	}
+	lock_release (&c->lock);
+}
+
+/* PAGES[0..PAGE_CNT-1]의 내용을 디스크 d의 SEC_NO부터 연속된 섹터에 쓴다.
+ * disk_read_pages와 마찬가지로 최대 MAX_SECTORS_PER_CMD 섹터씩 명령 하나로 처리한다. */
+void
+disk_write_pages (struct disk *d, disk_sector_t sec_no, void *const pages[],
+		size_t page_cnt) {
+	struct channel *c;
+	size_t total = page_cnt * SECTORS_PER_PAGE;
+	size_t done = 0;
+
+	ASSERT (d != NULL);
+	ASSERT (pages != NULL);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	while (done < total) {
+		size_t cnt = total - done;
+		if (cnt > MAX_SECTORS_PER_CMD)
+			cnt = MAX_SECTORS_PER_CMD;
+
+		select_sector (d, sec_no + done, cnt);
+		issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
+		for (size_t i = 0; i < cnt; i++, done++) {
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name,
+						(disk_sector_t) (sec_no + done));
+			output_sector (c, page_sector (pages, done));
+			/* 섹터 하나를 받을 때마다 인터럽트가 온다. */
+			sema_down (&c->completion_wait);
+		}
+		d->write_cnt += cnt;
+	}
+	lock_release (&c->lock);
+}
+
 /* Disk detection and identification. */
 
 static void print_ata_string (char *string, size_t size);
@@ -398,17 +481,19 @@ print_ata_string (char *string, size_t size) {
 }
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
+   writes SEC_NO and the sector count CNT to the disk's sector
+   selection registers.  (We use LBA mode.)  A count of
+   MAX_SECTORS_PER_CMD is encoded as 0. */
 static void
-select_sector (struct disk *d, disk_sector_t sec_no) {
+select_sector (struct disk *d, disk_sector_t sec_no, size_t cnt) {
 	struct channel *c = d->channel;
 
-	ASSERT (sec_no < d->capacity);
-	ASSERT (sec_no < (1UL << 28));
+	ASSERT (cnt >= 1 && cnt <= MAX_SECTORS_PER_CMD);
+	ASSERT (sec_no + cnt <= d->capacity);
+	ASSERT (sec_no + cnt <= (1UL << 28));
 
 	select_device_wait (d);
-	outb (reg_nsect (c), 1);
+	outb (reg_nsect (c), (uint8_t) cnt);
 	outb (reg_lbal (c), sec_no);
 	outb (reg_lbam (c), sec_no >> 8);
 	outb (reg_lbah (c), (sec_no >> 16));
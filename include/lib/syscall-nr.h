@@ -36,6 +36,15 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Extra for Project 3 */
+	SYS_MSYNC,                  /* Write dirty mmap pages back to the file. */
+	SYS_WORKING_SET,            /* Estimated working set of the process, in pages. */
+	SYS_MADVISE,                /* Advise the VM about an address range's access pattern. */
+	SYS_MUNMAP_RANGE,           /* Unmap part of one or more mappings. */
+	SYS_MPROTECT,               /* Change write permission of a range. */
+	SYS_RSS_LIMIT,              /* Limit the process's resident pages. */
+	SYS_RESIDENT_SET,           /* Resident pages of the process. */
 };
 
 #endif /* lib/syscall-nr.h */
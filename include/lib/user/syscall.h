@@ -13,6 +13,20 @@ typedef int pid_t;
 typedef int off_t;
 #define MAP_FAILED ((void *) NULL)
 
+/* Flag ORed into mmap()'s WRITABLE argument: read the whole
+   mapping in immediately instead of on first access. */
+#define MAP_POPULATE 0x2
+
+/* Flag ORed into mmap()'s WRITABLE argument: if ADDR is NULL, let
+   the kernel pick a free, suitably aligned address. */
+#define MAP_ANYWHERE 0x4
+
+/* ADVICE values for madvise(). */
+#define MADV_NORMAL 0           /* No special treatment. */
+#define MADV_SEQUENTIAL 2       /* Read ahead aggressively, drop pages behind. */
+#define MADV_WILLNEED 3         /* Prefetch the range now. */
+#define MADV_DONTNEED 4         /* Discard the range's frames and swap. */
+
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
@@ -41,6 +55,13 @@ int dup2(int oldfd, int newfd);
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap (void *addr);
+int msync (void *addr, size_t length);
+size_t working_set (void);
+int madvise (void *addr, size_t length, int advice);
+int munmap_range (void *addr, size_t length);
+int mprotect (void *addr, size_t length, bool writable);
+void rss_limit (size_t pages);
+size_t resident_set (void);
 
 /* Project 4 only. */
 bool chdir (const char *dir);
@@ -78,4 +99,53 @@ get_fs_disk_write_cnt (void) {
 	return write_cnt;
 }
 
+static inline long long
+get_major_fault_cnt (void) {
+	long long fault_cnt;
+	asm volatile ("int $0x45");
+	asm volatile ("\t movq %%rax, %0": "=r" (fault_cnt));
+	return fault_cnt;
+}
+
+/* get_reclaim_stat()의 selector. vm/inspect.c의 int 0x46 참고 */
+enum reclaim_stat {
+	RECLAIM_WMARK_LOW,      /* 데몬이 깨어나는 빈 프레임 수 */
+	RECLAIM_WMARK_HIGH,     /* 데몬이 채우는 목표 빈 프레임 수 */
+	RECLAIM_FREE_FRAMES,    /* 현재 빈 유저 프레임 수 */
+	RECLAIM_WAKEUPS,        /* 데몬이 깨어난 횟수 */
+	RECLAIM_RECLAIMED,      /* 데몬이 비운 프레임 수 */
+	RECLAIM_SWAP_READAHEADS, /* swap-in 때 함께 읽어 스왑 캐시에 넣은 페이지 수 */
+	RECLAIM_SWAP_CACHE_HITS, /* 스왑 캐시 덕분에 디스크를 읽지 않은 swap-in 수 */
+	RECLAIM_TEXT_SHARES,    /* 다른 프로세스가 올려둔 코드 프레임을 재사용한 횟수 */
+	RECLAIM_SHARED_EVICTIONS, /* 여러 프로세스가 공유하던 프레임을 쫓아낸 수 */
+	RECLAIM_SWAP_OUT_OVERLAPS, /* eviction이 디스크에 쓰는 동안 처리된 page fault 수 */
+};
+
+static inline long long
+get_reclaim_stat (enum reclaim_stat which) {
+	long long value;
+	asm volatile ("movq %1, %%rax; int $0x46; movq %%rax, %0"
+			: "=r" (value) : "r" ((long long) which) : "rax", "memory");
+	return value;
+}
+
+/* get_fault_stat()의 selector. include/vm/vm.h의 enum vm_fault_class와 같은 순서 */
+enum fault_stat {
+	FAULT_MINOR,            /* 디스크를 읽지 않고 처리한 폴트 */
+	FAULT_MAJOR_SWAP,       /* 스왑에서 읽어 온 폴트 */
+	FAULT_MAJOR_FILE,       /* 파일에서 읽어 온 폴트 */
+	FAULT_STACK,            /* 스택 증가 */
+	FAULT_WP,               /* 쓰기 금지 폴트 (COW 등) */
+	FAULT_INVALID,          /* 처리하지 못한 폴트 */
+};
+
+/* 현재 프로세스가 지금까지 겪은 WHICH 분류의 page fault 수 (int 0x47) */
+static inline long long
+get_fault_stat (enum fault_stat which) {
+	long long value;
+	asm volatile ("movq %1, %%rax; int $0x47; movq %%rax, %0"
+			: "=r" (value) : "r" ((long long) which) : "rax", "memory");
+	return value;
+}
+
 #endif /* lib/user/syscall.h */
@@ -19,9 +19,13 @@ bool pml4_is_dirty (uint64_t *pml4, const void *upage);
 void pml4_set_dirty (uint64_t *pml4, const void *upage, bool dirty);
 bool pml4_is_accessed (uint64_t *pml4, const void *upage);
 void pml4_set_accessed (uint64_t *pml4, const void *upage, bool accessed);
+void pml4_set_writable (uint64_t *pml4, const void *upage, bool writable);
+bool pml4_set_large_page (uint64_t *pml4, void *upage, void *kpage, bool rw);
+bool pml4_is_large_page (uint64_t *pml4, const void *upage);
 
 #define is_writable(pte) (*(pte) & PTE_W)
 #define is_user_pte(pte) (*(pte) & PTE_U)
+#define is_large_pte(pte) (*(pte) & PTE_PS)
 #define is_kern_pte(pte) (!is_user_pte (pte))
 
 #define pte_get_paddr(pte) (pg_round_down(*(pte)))
@@ -41,5 +41,13 @@
 #define PTE_U 0x4                        /* 1=user/kernel, 0=kernel only. */
 #define PTE_A 0x20                       /* 1=accessed, 0=not acccessed. */
 #define PTE_D 0x40                       /* 1=dirty, 0=not dirty (PTEs only). */
+#define PTE_PS 0x80                      /* 1=2 MB page (PDEs only). */
+
+/* A PDE with PTE_PS maps LARGE_PGSIZE bytes directly, without a
+   page table underneath. */
+#define LARGE_PGSIZE (1UL << PDXSHIFT)   /* Bytes in a large page. */
+#define LARGE_PGCNT (LARGE_PGSIZE >> PTXSHIFT) /* 4 kB pages in a large page. */
+#define large_pg_ofs(va) ((uint64_t) (va) & (LARGE_PGSIZE - 1))
+#define large_pg_round_down(va) ((void *) ((uint64_t) (va) & ~(LARGE_PGSIZE - 1)))
 
 #endif /* threads/pte.h */
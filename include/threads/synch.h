@@ -13,6 +13,7 @@ struct semaphore {
 void sema_init(struct semaphore *, unsigned value);
 void sema_down(struct semaphore *);
 bool sema_try_down(struct semaphore *);
+bool sema_down_killable(struct semaphore *);
 void sema_up(struct semaphore *);
 void sema_self_test(void);
 
@@ -106,7 +106,9 @@ struct thread {
     struct list donations;          // 다른 스레드가 우선순위를 기부했을 경우 여기에 저장
     struct list_elem donation_elem; // 우선순위를 기부할 경우 이 포인터를 해당 스레드의 donations 리스트에 저장
 
-    struct list_elem elem; /* 원래 포함되어 있는, 가장 기본적인 thread elem */
+    struct list_elem elem;     /* 원래 포함되어 있는, 가장 기본적인 thread elem */
+    struct list_elem all_elem; // 살아있는 모든 스레드의 리스트 (all_list) 삽입 목적
+    struct semaphore *killable_sema; // sema_down_killable로 잠들어 있는 동안 기다리는 세마포어 (thread_interrupt로 깨울 수 있음)
 
 // #ifdef USERPROG
 
@@ -140,6 +142,14 @@ struct thread {
     struct supplemental_page_table spt;
     void* stack_bottom;
     void* rsp_stack;
+    long long fault_cnt[VM_FAULT_CLASS_CNT]; // 이 프로세스의 분류별 page fault 수 (vm_try_handle_fault)
+    size_t ws_estimate;  // working set 추정치 (페이지 수). 샘플마다 절반씩 감쇠
+    size_t ws_sample;    // 현재 샘플 구간에서 접근이 확인된 페이지 수
+    unsigned ws_epoch;   // ws_estimate에 반영된 마지막 샘플 회차
+    size_t rss;          // 이 프로세스의 페이지가 매핑된 프레임 수 (zero 프레임 제외). frame_lock으로 보호
+    size_t rss_limit;    // rss 상한 (0이면 없음). fork로 물려받고 exec 후에도 유지
+    size_t swap_pages;   // 이 프로세스의 anon 페이지가 붙들고 있는 스왑 슬롯 수
+    bool oom_killed;     // OOM killer가 희생자로 골랐음. 유저 모드로 돌아가기 전 (폴트, 시스템 콜, 인터럽트)에 종료한다
 // #endif
 
     /* Owned by thread.c. */
@@ -189,6 +199,11 @@ bool comparison_for_sleeplist_insertion(const struct list_elem *new, const struc
 bool comparison_for_readylist_insertion(const struct list_elem *new, const struct list_elem *existing, void *aux UNUSED);
 bool comparison_for_priority_donation(const struct list_elem *new, const struct list_elem *existing, void *aux UNUSED);
 void thread_check_yield(void);
+void thread_interrupt(struct thread *t);
+
+/* 살아있는 모든 스레드에 대해 수행할 함수 (thread_foreach) */
+typedef void thread_action_func(struct thread *t, void *aux);
+void thread_foreach(thread_action_func *func, void *aux);
 
 void file_lock_acquire();
 void file_lock_release();
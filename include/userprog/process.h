@@ -9,5 +9,6 @@ int process_exec(void *f_name);
 int process_wait(tid_t);
 void process_exit(void);
 void process_activate(struct thread *next);
+void process_check_killed(void);
 
 #endif /* userprog/process.h */
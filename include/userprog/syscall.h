@@ -2,8 +2,9 @@
 #define USERPROG_SYSCALL_H
 
 void syscall_init(void);
-void file_lock_acquire();
-void file_lock_release();
-void fd_table_close();
+void exit(int status);
+void file_lock_acquire(void);
+void file_lock_release(void);
+void fd_table_close(void);
 
 #endif /* userprog/syscall.h */
@@ -1,17 +1,27 @@
 #ifndef VM_ANON_H
 #define VM_ANON_H
 #include "vm/vm.h"
-#include "devices/disk.h"
+#include "vm/swap.h"
 struct page;
 enum vm_type;
 
 struct anon_page {
-    // 디스크는 총 섹터 수 정해져 있음 (비트맵에 매핑 -> 비트맵 스캔하면 비어있는 섹터를 바로 찾을 수 있음 , 찾은 위치부터 비어있는데 채우고 )
-    disk_sector_t start_sector_num;   // start부터 8개는 무조건 한 페이지꺼 (인덱스)
+    swap_slot_t slot;   // 내용이 저장된 스왑 슬롯, 없으면 SWAP_SLOT_NONE.
+                        // swap in 된 뒤에도 쓰기 전까지는 슬롯 내용이 그대로이므로 유지한다
 };
 
+/* anon_swap_out_begin이 모은, 스왑 디스크에 써야 하는 페이지들의 슬롯과 내용 */
+struct anon_swap_batch {
+    swap_slot_t slots[SWAP_BATCH_MAX];
+    void *kvas[SWAP_BATCH_MAX];
+    size_t cnt;
+};
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+size_t anon_swap_out_begin (struct page *pages[], size_t cnt, struct anon_swap_batch *batch);
+void anon_swap_out_end (struct page *page);
+void anon_release_slot (struct page *page);
+void anon_share_slot (struct page *dst, struct page *src);
 
 #endif
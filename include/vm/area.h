@@ -0,0 +1,51 @@
+#ifndef VM_AREA_H
+#define VM_AREA_H
+#include <list.h>
+#include "filesys/off_t.h"
+#include "vm/vm.h"
+
+struct supplemental_page_table;
+
+/* madvise()의 ADVICE. lib/user/syscall.h의 값과 같아야 한다 */
+#define MADV_NORMAL 0       /* 기본 동작 */
+#define MADV_SEQUENTIAL 2   /* 앞에서부터 차례로 읽는다: readahead를 늘리고 지나간 페이지는 먼저 쫓아냄 */
+#define MADV_WILLNEED 3     /* 곧 쓴다: 빈 프레임이 있는 만큼 미리 읽어 둔다 */
+#define MADV_DONTNEED 4     /* 당분간 안 쓴다: 프레임과 스왑 슬롯을 바로 반환 */
+
+/* 가상 메모리 영역 (VMA). ELF 세그먼트나 mmap 하나를 페이지 수와 상관없이
+ * 구조체 하나로 표현한다. 영역 안의 struct page는 처음 폴트가 날 때
+ * (또는 fault-around, MAP_POPULATE 등이 건드릴 때) 영역 정보로부터 만들어진다. */
+struct vm_area {
+	void *start;               /* 페이지 정렬된 시작 주소 */
+	void *end;                 /* 페이지 정렬된 끝 주소 (포함하지 않음) */
+	enum vm_type type;         /* 만들어질 페이지의 타입 (VM_ANON, VM_FILE, VM_FILE | VM_TEXT, VM_FILE | VM_PRIVATE) */
+	bool writable;
+	vm_initializer *init;      /* 만들어질 uninit 페이지의 초기화 함수 */
+	struct file *file;         /* 영역이 소유한 파일 (VM_TEXT, VM_PRIVATE면 NULL) */
+	struct inode *inode;       /* VM_TEXT, VM_PRIVATE 영역이 소유한 실행 파일의 inode 참조 */
+	off_t ofs;                 /* start에 대응하는 파일 오프셋 */
+	size_t read_bytes;         /* start부터 파일에서 읽는 바이트 수. 나머지는 0 */
+	int advice;                /* madvise로 받은 접근 패턴 (MADV_NORMAL, MADV_SEQUENTIAL) */
+	struct list_elem elem;     /* supplemental_page_table의 areas */
+};
+
+struct vm_area *vm_area_create (struct supplemental_page_table *spt,
+		void *start, size_t length, enum vm_type type, bool writable,
+		vm_initializer *init);
+struct vm_area *vm_area_find (struct supplemental_page_table *spt,
+		const void *va);
+struct vm_area *vm_area_find_overlap (struct supplemental_page_table *spt,
+		void *start, void *end);
+bool vm_area_overlaps (struct supplemental_page_table *spt,
+		void *start, void *end);
+void *vm_area_find_free (struct supplemental_page_table *spt, size_t length);
+struct vm_area *vm_area_split (struct supplemental_page_table *spt,
+		struct vm_area *area, void *addr);
+struct page *vm_area_materialize (struct supplemental_page_table *spt,
+		void *va);
+void vm_area_remove (struct supplemental_page_table *spt,
+		struct vm_area *area);
+bool vm_area_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src);
+void vm_area_kill (struct supplemental_page_table *spt);
+#endif
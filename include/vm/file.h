@@ -6,8 +6,15 @@
 struct page;
 enum vm_type;
 
+/* do_mmap()의 writable 인자에 OR로 함께 넘어오는 플래그 (lib/user/syscall.h와 같은 값) */
+#define MAP_POPULATE 0x2
+/* addr이 NULL이면 실패하는 대신 커널이 빈 자리를 골라 매핑한다 */
+#define MAP_ANYWHERE 0x4
+
 struct file_page {
 	struct file *file;
+	struct inode *inode;	/* VM_TEXT, VM_PRIVATE 페이지면 실행 파일의 inode (file은 NULL) */
+	bool private;		/* VM_PRIVATE: 아직 쓰지 않은 ELF 데이터 페이지 */
 	off_t offset;
 	size_t read_bytes;
 	int page_cnt;
@@ -18,4 +25,9 @@ bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
+int do_munmap_range (void *addr, size_t length);
+int do_msync (void *addr, size_t length);
+bool file_backed_writeback (struct page *page);
+bool lazy_load_text (struct page *page, void *aux);
+void file_text_attach (struct page *page);
 #endif
@@ -1,4 +1,7 @@
 #ifndef _VM_INSPECT_H_
 #define _VM_INSPECT_H_
 void register_inspect_intr (void);
+void register_vm_stat_intr (void);
+void register_reclaim_stat_intr (void);
+void register_fault_stat_intr (void);
 #endif
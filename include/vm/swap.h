@@ -0,0 +1,27 @@
+#ifndef VM_SWAP_H
+#define VM_SWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "devices/disk.h"
+
+/* 스왑 디스크의 페이지 크기 슬롯 번호. 슬롯 N은 섹터 N * 8 ~ N * 8 + 7 */
+typedef uint32_t swap_slot_t;
+
+/* 슬롯이 없음 (0번 슬롯도 유효하므로 -1 사용) */
+#define SWAP_SLOT_NONE ((swap_slot_t) -1)
+
+/* swap_write_batch가 한 번에 받는 최대 페이지 수 */
+#define SWAP_BATCH_MAX 16
+
+extern size_t swap_readahead;
+
+bool swap_config_disk (int chan_no, int dev_no, int prio);
+void swap_init (struct disk *default_disk);
+swap_slot_t swap_slot_alloc (swap_slot_t hint);
+void swap_slot_dup (swap_slot_t slot);
+void swap_slot_free (swap_slot_t slot);
+bool swap_read (swap_slot_t slot, void *kva);
+void swap_write_batch (const swap_slot_t slots[], void *const kvas[], size_t cnt);
+bool swap_cache_reclaim (void);
+#endif
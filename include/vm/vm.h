@@ -24,9 +24,19 @@ enum vm_type {
 	VM_MARKER_END = (1 << 31),
 };
 
+/* 실행 파일의 read-only 코드 페이지. VM_FILE과 함께 쓰며,
+ * 같은 (inode, offset)을 매핑하는 프로세스들이 하나의 프레임을 공유한다. */
+#define VM_TEXT VM_MARKER_0
+
+/* ELF의 쓰기 가능한 데이터 세그먼트 페이지. VM_FILE과 함께 쓰며, 처음 쓰기 전까지는
+ * 실행 파일 내용 그대로이므로 쫓겨날 때 스왑에 쓰지 않고 버린 뒤 다시 읽는다.
+ * 처음 쓰는 순간 anon 페이지로 바뀐다 (vm_handle_wp). aux는 VM_TEXT와 같다 */
+#define VM_PRIVATE VM_MARKER_1
+
 #include "vm/uninit.h"
 #include "vm/anon.h"
 #include "vm/file.h"
+#include "vm/area.h"
 #include "include/lib/kernel/hash.h"
 #ifdef EFILESYS
 #include "filesys/page_cache.h"
@@ -45,10 +55,11 @@ struct page {
 	const struct page_operations *operations;
 	void *va;              /* Address in terms of user space */
 	struct frame *frame;   /* Back reference for frame */
-	struct hash_elem hash_elem;
 	bool writable;
 
 	/* Your implementation */
+	struct thread *owner;  /* 페이지를 소유한 프로세스 (eviction 시 owner의 pml4 사용) */
+	struct list_elem frame_page_elem;  /* frame->pages에 담기 위한 원소 (COW 공유) */
 
 	/* Per-type data are binded into the union.
 	 * Each function automatically detects the current union */
@@ -65,8 +76,16 @@ struct page {
 /* The representation of "frame" */
 struct frame {
 	void *kva;	// kernel virtual address
-	struct page *page;
+	struct page *page;	// 대표 페이지. 공유 중이면 pages 중 하나
 	struct list_elem frame_elem;	// frame_table에 구조체 담기 위해 선언
+	struct list pages;	// 이 프레임을 매핑한 페이지들 (fork 후 COW로 공유)
+	int ref_cnt;		// pages의 원소 수. 2 이상이면 쓰기 시 복사해야 한다
+	struct inode *text_inode;	// text_frames에 등록된 코드 프레임이면 실행 파일의 inode
+	off_t text_ofs;				// 실행 파일 내 오프셋 (text_inode와 함께 키)
+	struct hash_elem text_elem;	// text_frames에 담기 위한 원소
+	uint8_t ws_age;		// working set 샘플마다 오른쪽으로 밀고, 그 구간에 접근했으면 최상위 비트를 켠다
+	int pin_cnt;		// 0보다 크면 eviction 대상에서 제외 (내용을 채우는 중이거나 커널이 버퍼로 사용 중)
+	bool in_io;			// frame_lock 없이 디스크 I/O 중. 끝날 때까지 해제하지 않는다 (pin_cnt도 올라가 있음)
 };
 
 /* The function table for page operations.
@@ -87,11 +106,99 @@ struct page_operations {
 
 /* Representation of current process's memory space.
  * We don't want to force you to obey any specific design for this struct.
- * All designs up to you for this. */
+ * All designs up to you for this.
+ * 가상 페이지 번호를 키로 하는 4단계 radix tree. 페이지 테이블과 똑같이 주소를
+ * PML4/PDPE/PDX/PTX 9비트씩 나눠 인덱스로 쓰므로 노드 하나가 (포인터 512개) 커널 페이지 한 장이고,
+ * 마지막 단계 노드의 슬롯에 struct page 포인터가 들어 있다.
+ * 조회에 메모리 할당이 필요 없고, 주소 순서대로 순회하거나 범위를 찾을 수 있다.
+ * ELF 세그먼트와 mmap은 areas의 vm_area 하나로 기술되고, 그 안의 페이지는
+ * 처음 필요해질 때 트리에 만들어진다 (spt_get_page). */
+#define SPT_LEVELS 4
 struct supplemental_page_table {
-	struct hash hash_table;
+	void *root;            /* 최상위 노드. 페이지가 한 번도 들어오지 않았으면 NULL */
+	struct list areas;     /* struct vm_area 목록 */
 };
 
+/* 프레임이 부족할 때 희생 프레임을 고르는 정책.
+ * 커널 커맨드라인 옵션 -evict=fifo|clock 으로 선택한다. */
+enum vm_evict_policy {
+	VM_EVICT_FIFO,    /* frame_table 맨 앞의 프레임을 그대로 쫓아냄 */
+	VM_EVICT_CLOCK,   /* accessed bit를 이용한 second-chance (기본값) */
+};
+extern enum vm_evict_policy vm_evict_policy;
+
+/* true면 정렬된 2MB 영역 전체가 아직 로드되지 않았을 때 2MB 페이지 하나로 매핑 (-large-pages) */
+extern bool vm_large_pages;
+
+/* 파일에서 읽는 페이지에 폴트가 나면 그 페이지를 포함해 최대 이만큼의 이어지는 페이지를
+ * 한 번에 올린다 (-fault-around=PAGES). 1이면 fault-around를 하지 않음 */
+extern size_t vm_fault_around_pages;
+
+/* VM 통계. 종료 시 vm_print_stats()로 출력하고 inspect 인터럽트로도 조회 가능 */
+struct vm_stat {
+	long long major_faults;   /* 스왑 디스크나 파일에서 다시 읽어온 page fault 수 */
+	long long evictions;      /* 쫓겨난 프레임 수 */
+	long long cow_faults;     /* 공유 프레임에 쓰다가 복사한 횟수 */
+	long long text_shares;    /* 다른 프로세스가 올려둔 코드 프레임을 재사용한 횟수 */
+	long long shared_evictions; /* 여러 페이지가 공유하던 프레임을 모든 매핑에서 떼어 쫓아낸 수 */
+	long long swap_readaheads;  /* swap-in 때 함께 읽어 스왑 캐시에 넣은 페이지 수 */
+	long long swap_cache_hits;  /* 스왑 캐시 덕분에 디스크를 읽지 않은 swap-in 수 */
+	long long swap_clean_evictions; /* swap-in 후 쓰지 않아 슬롯에 다시 쓰지 않고 쫓아낸 anon 페이지 수 */
+	long long swap_slots_released;  /* 스왑 공간이 부족해 메모리에 있는 페이지에게서 회수한 슬롯 수 */
+	long long swap_parallel_ios;    /* 다른 채널의 스왑 디스크와 동시에 처리한 디스크 명령 수 */
+	long long swap_out_overlaps;    /* eviction이 락 없이 스왑/파일에 쓰는 동안 다른 스레드가 처리한 폴트 수 */
+	long long reclaim_wakeups;  /* reclaim 데몬이 깨어난 횟수 */
+	long long reclaimed_frames; /* reclaim 데몬이 미리 비워둔 프레임 수 */
+	long long evict_batches;    /* 한 번에 둘 이상의 프레임을 쫓아낸 일괄 reclaim 횟수 */
+	long long frame_cache_hits; /* 빈 프레임 캐시에서 꺼내 쓴 프레임 수 */
+	long long writeback_pages;  /* writeback 데몬이 파일에 써 준 dirty mmap 페이지 수 */
+	long long zero_page_maps;   /* 프레임 대신 공용 zero 프레임을 매핑한 읽기 폴트 수 */
+	long long large_page_maps;  /* 2MB 페이지로 한 번에 매핑한 폴트 수 */
+	long long fault_around_pages; /* 폴트 없이 fault-around로 미리 올린 페이지 수 */
+	long long populated_pages;  /* mmap(MAP_POPULATE)이 미리 읽어 매핑한 페이지 수 */
+	long long ws_samples;       /* working set 샘플 회차 수 */
+	long long ws_peak;          /* 프로세스 하나의 working set 추정치 최댓값 (페이지) */
+	long long ws_system_peak;   /* 시스템 전체 working set 추정치 최댓값 (프레임) */
+	long long zswap_stores;     /* 디스크 대신 압축 풀에 넣은 swap-out 수 */
+	long long zswap_loads;      /* 디스크 대신 압축 풀에서 푼 swap-in 수 */
+	long long zswap_spills;     /* 압축 풀이 넘쳐 디스크로 옮긴 페이지 수 */
+	long long zswap_rejects;    /* 압축이 잘 안 돼서 바로 디스크에 쓴 페이지 수 */
+	long long madv_prefetched;  /* madvise(MADV_WILLNEED)가 미리 읽어 둔 페이지 수 */
+	long long madv_dropped;     /* madvise(MADV_DONTNEED)가 버린 페이지 수 */
+	long long seq_deactivated;  /* MADV_SEQUENTIAL 영역에서 지나간 뒤 먼저 쫓아내도록 돌린 페이지 수 */
+	long long rss_evictions;    /* RSS 한도에 닿은 프로세스가 자기 페이지를 내보내고 받은 프레임 수 */
+	long long data_anon_pages;  /* 처음 쓰여서 anon 페이지가 된 ELF 데이터 페이지 수 */
+	long long oom_kills;        /* 프레임도 스왑 공간도 없어서 OOM killer가 종료시킨 프로세스 수 */
+	char oom_victim[16];        /* 마지막 희생자의 이름과 그때의 rss, 스왑 슬롯 수 */
+	size_t oom_victim_rss;
+	size_t oom_victim_swap;
+};
+extern struct vm_stat vm_stat;
+
+/* page fault 분류. vm_try_handle_fault가 처리 결과에 따라 하나로 센다 */
+enum vm_fault_class {
+	VM_FAULT_MINOR,         /* 디스크를 읽지 않고 처리 (zero 페이지, 0으로 채우는 anon, 공유 코드 프레임) */
+	VM_FAULT_MAJOR_SWAP,    /* 스왑에서 다시 읽어 온 anon 페이지 */
+	VM_FAULT_MAJOR_FILE,    /* 실행 파일이나 mmap한 파일에서 읽어 온 페이지 */
+	VM_FAULT_STACK,         /* 스택 증가 */
+	VM_FAULT_WP,            /* 쓰기 금지 폴트 (COW 복사, zero 프레임에 처음 쓰기) */
+	VM_FAULT_INVALID,       /* 처리하지 못한 폴트 */
+	VM_FAULT_CLASS_CNT
+};
+
+/* 분류별 폴트 수와 처리 시간 (TSC 사이클)의 log2 히스토그램.
+ * hist[c][b]는 처리에 2^b 이상 2^(b+1) 미만 사이클이 걸린 c 분류 폴트 수 */
+#define VM_FAULT_HIST_BUCKETS 40
+struct vm_fault_stat {
+	long long cnt[VM_FAULT_CLASS_CNT];
+	long long hist[VM_FAULT_CLASS_CNT][VM_FAULT_HIST_BUCKETS];
+};
+extern struct vm_fault_stat vm_fault_stat;
+
+/* 빈 유저 프레임이 low 아래로 내려가면 reclaim 데몬이 깨어나 high까지 채운다 */
+extern size_t vm_watermark_low;
+extern size_t vm_watermark_high;
+
 struct lazy_load_aux_file {
 	struct file *file;
 	off_t ofs;
@@ -101,6 +208,14 @@ struct lazy_load_aux_file {
 	int64_t page_cnt;
 };
 
+/* VM_TEXT, VM_PRIVATE 페이지의 aux. 실행 파일이 닫힌 뒤에도 (fork한 자식 등) 읽을 수 있도록
+ * struct file 대신 inode 참조를 직접 갖는다. */
+struct lazy_load_aux_text {
+	struct inode *inode;
+	off_t ofs;
+	uint32_t read_bytes;
+};
+
 struct lazy_load_aux {
 	struct file *file;
 	off_t ofs;
@@ -117,8 +232,12 @@ struct page *spt_find_page (struct supplemental_page_table *spt,
 		void *va);
 bool spt_insert_page (struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
+struct page *spt_find_range (struct supplemental_page_table *spt,
+		void *start, void *end);
+struct page *spt_get_page (struct supplemental_page_table *spt, void *va);
 
 void vm_init (void);
+void vm_print_stats (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 		bool write, bool not_present);
 
@@ -127,7 +246,19 @@ bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 		bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page (struct page *page);
+bool vm_pin_page (struct page *page);
+void vm_unpin_page (struct page *page);
+bool vm_wait_io (struct page *page);
+bool vm_pin_buffer (const void *uaddr, size_t size, bool write);
+void vm_unpin_buffer (const void *uaddr, size_t size);
+bool vm_free_frame (struct page *page);
+bool vm_release_swap_slots (void);
+void vm_install_frame (struct page *page, void *kva);
 bool vm_claim_page (void *va);
+size_t vm_working_set (void);
+int vm_madvise (void *addr, size_t length, int advice);
+int vm_mprotect (void *addr, size_t length, bool writable);
+bool vm_prepare_write (void *uaddr, size_t size);
 enum vm_type page_get_type (struct page *page);
 
 #endif  /* VM_VM_H */
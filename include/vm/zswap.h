@@ -0,0 +1,19 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+#include <stdbool.h>
+#include <stddef.h>
+#include "vm/swap.h"
+
+/* 압축 풀이 쓸 수 있는 최대 커널 메모리 (페이지 수, 커맨드라인 -zswap=PAGES).
+ * ZSWAP_AUTO면 유저 풀의 1/16, 0이면 압축 풀을 쓰지 않는다 */
+#define ZSWAP_AUTO ((size_t) -1)
+extern size_t zswap_max_pages;
+
+/* 아래 함수들은 모두 swap.c가 swap_lock을 잡은 상태에서 호출한다 */
+void zswap_init (void);
+bool zswap_store (swap_slot_t slot, const void *kva);
+bool zswap_load (swap_slot_t slot, void *kva, bool drop);
+bool zswap_contains (swap_slot_t slot);
+void zswap_invalidate (swap_slot_t slot);
+bool zswap_spill (swap_slot_t *slot, void *kva);
+#endif
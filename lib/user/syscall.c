@@ -82,6 +82,20 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset) { retu
 
 void munmap(void *addr) { syscall1(SYS_MUNMAP, addr); }
 
+int msync(void *addr, size_t length) { return syscall2(SYS_MSYNC, addr, length); }
+
+size_t working_set(void) { return syscall0(SYS_WORKING_SET); }
+
+int madvise(void *addr, size_t length, int advice) { return syscall3(SYS_MADVISE, addr, length, advice); }
+
+int munmap_range(void *addr, size_t length) { return syscall2(SYS_MUNMAP_RANGE, addr, length); }
+
+int mprotect(void *addr, size_t length, bool writable) { return syscall3(SYS_MPROTECT, addr, length, writable); }
+
+void rss_limit(size_t pages) { syscall1(SYS_RSS_LIMIT, pages); }
+
+size_t resident_set(void) { return syscall0(SYS_RESIDENT_SET); }
+
 bool chdir(const char *dir) { return syscall1(SYS_CHDIR, dir); }
 
 bool mkdir(const char *dir) { return syscall1(SYS_MKDIR, dir); }
@@ -0,0 +1,52 @@
+/* Fault-path lookup benchmark for the supplemental page table.
+   A 512 MB zero-filled array gives the process more than 128k
+   pages in its SPT.  Reading one byte of each page takes one page
+   fault per page, and every fault looks the page up in the SPT
+   before mapping the shared zero frame, so the average cycles per
+   fault (measured with rdtsc) tracks the lookup cost.  A second
+   pass over the now-mapped pages gives the no-fault baseline.
+
+   Not part of the test suite: the SPT alone needs well over 16 MB
+   of kernel memory, e.g.
+     pintos -m 256 --swap-disk=4 -- -q -f run bench-spt */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define BUF_PAGES (128 * 1024 + 1024)
+
+static char buf[(size_t) BUF_PAGES * PAGE_SIZE];
+
+static inline uint64_t
+rdtsc (void)
+{
+  uint32_t lo, hi;
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+static uint64_t
+scan (void)
+{
+  volatile char sink = 0;
+  uint64_t start = rdtsc ();
+  size_t i;
+
+  for (i = 0; i < BUF_PAGES; i++)
+    sink += buf[i * PAGE_SIZE];
+  return rdtsc () - start;
+}
+
+void
+test_main (void)
+{
+  uint64_t faulting = scan ();
+  uint64_t mapped = scan ();
+
+  msg ("%d pages: %llu cycles per faulting access, %llu per mapped access",
+       BUF_PAGES, (unsigned long long) (faulting / BUF_PAGES),
+       (unsigned long long) (mapped / BUF_PAGES));
+}
@@ -0,0 +1,55 @@
+/* Page-walk/TLB microbenchmark.  Touches every page of a buffer
+   that is much larger than the TLB reach with 4 kB pages, then
+   times repeated strided passes over it with rdtsc and reports
+   the average cycles per access.
+
+   Not part of the test suite.  Run it with and without the
+   kernel's -large-pages option and compare, e.g.:
+     pintos -m 40 --swap-disk=4 -- -q -f run bench-tlb
+     pintos -m 40 --swap-disk=4 -- -q -large-pages -f run bench-tlb
+   The "VM: ... large page maps" line printed at shutdown shows
+   how many 2 MB pages were used. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define ONE_MB (1 << 20)
+#define BUF_SIZE (16 * ONE_MB)
+#define BUF_PAGES (BUF_SIZE / PAGE_SIZE)
+#define PASSES 64
+
+/* Extra 2 MB so that the buffer covers whole aligned regions. */
+static char buf[BUF_SIZE + 2 * ONE_MB];
+
+static inline uint64_t
+rdtsc (void)
+{
+  uint32_t lo, hi;
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64_t) hi << 32) | lo;
+}
+
+void
+test_main (void)
+{
+  char *region = (char *) (((uintptr_t) buf + 2 * ONE_MB - 1)
+                           & ~(uintptr_t) (2 * ONE_MB - 1));
+  volatile char sink = 0;
+  uint64_t start, cycles;
+  size_t i, pass;
+
+  for (i = 0; i < BUF_PAGES; i++)
+    region[i * PAGE_SIZE] = (char) i;
+
+  start = rdtsc ();
+  for (pass = 0; pass < PASSES; pass++)
+    for (i = 0; i < BUF_PAGES; i++)
+      sink += region[i * PAGE_SIZE + (pass * 64) % PAGE_SIZE];
+  cycles = rdtsc () - start;
+
+  msg ("%d accesses, %llu cycles per access", BUF_PAGES * PASSES,
+       (unsigned long long) (cycles / ((uint64_t) BUF_PAGES * PASSES)));
+}
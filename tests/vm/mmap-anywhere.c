@@ -0,0 +1,56 @@
+/* Maps a file twice with MAP_ANYWHERE and a null address, so the
+   kernel picks two non-overlapping places.  Then unmaps the middle
+   page of one mapping with munmap_range() and maps something else
+   there, checking that the pages around the hole survive.  Finally
+   makes part of the other mapping writable with mprotect(). */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char file_buf[10016];
+
+void
+test_main (void)
+{
+  char *p, *q, *hole;
+  int handle;
+  size_t size;
+
+  CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+  size = filesize (handle);
+  if (read (handle, file_buf, size) != (int) size)
+    fail ("read \"small.txt\"");
+
+  CHECK ((p = mmap (NULL, size, MAP_ANYWHERE, handle, 0)) != MAP_FAILED,
+         "mmap \"small.txt\" anywhere");
+  CHECK ((q = mmap (NULL, size, MAP_ANYWHERE, handle, 0)) != MAP_FAILED,
+         "mmap \"small.txt\" anywhere again");
+  if (p < q + size && q < p + size)
+    fail ("mappings at %p and %p overlap", p, q);
+  if (memcmp (p, file_buf, size) || memcmp (q, file_buf, size))
+    fail ("mapping differs from file");
+
+  hole = p + PAGE_SIZE;
+  CHECK (munmap_range (hole, PAGE_SIZE) == 0, "unmap middle page");
+  CHECK (mmap (hole, PAGE_SIZE, 0, handle, 0) == hole, "mmap into the hole");
+  if (memcmp (hole, file_buf, PAGE_SIZE))
+    fail ("hole mapping differs from file");
+  if (memcmp (p, file_buf, PAGE_SIZE)
+      || memcmp (p + 2 * PAGE_SIZE, file_buf + 2 * PAGE_SIZE,
+                 size - 2 * PAGE_SIZE))
+    fail ("pages around the hole changed");
+  CHECK (munmap_range (file_buf, PAGE_SIZE) == -1,
+         "munmap_range on data segment");
+
+  CHECK (mprotect (q, PAGE_SIZE, true) == 0, "mprotect first page writable");
+  q[0] = 'x';
+  if (q[0] != 'x')
+    fail ("write to mprotected page lost");
+  CHECK (mprotect ((char *) 0x20000000, PAGE_SIZE, true) == -1,
+         "mprotect on unmapped range");
+  CHECK (munmap_range (p, size) == 0, "unmap first mapping and hole");
+}
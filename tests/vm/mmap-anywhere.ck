@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-anywhere) begin
+(mmap-anywhere) open "small.txt"
+(mmap-anywhere) mmap "small.txt" anywhere
+(mmap-anywhere) mmap "small.txt" anywhere again
+(mmap-anywhere) unmap middle page
+(mmap-anywhere) mmap into the hole
+(mmap-anywhere) munmap_range on data segment
+(mmap-anywhere) mprotect first page writable
+(mmap-anywhere) mprotect on unmapped range
+(mmap-anywhere) unmap first mapping and hole
+(mmap-anywhere) end
+EOF
+pass;
@@ -0,0 +1,62 @@
+/* Maps an 8-page file with the kernel's -fault-around=4 option and
+   checks through int 0x42 that reading the first page also maps
+   the next three pages of the file, but not the fifth.  Reading the
+   fifth page then brings in the rest of the window. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define FILE_PAGES 8
+#define WINDOW 4
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[PAGE_SIZE];
+
+static void
+check_loaded (size_t first, size_t last)
+{
+  size_t i;
+
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      bool loaded = get_phys_addr (ACTUAL + i * PAGE_SIZE) != 0;
+      if (loaded != (i >= first && i < last))
+        fail ("page %zu is %sloaded", i, loaded ? "" : "not ");
+    }
+}
+
+void
+test_main (void)
+{
+  int handle;
+  size_t i;
+
+  CHECK (create ("pages", FILE_PAGES * PAGE_SIZE), "create \"pages\"");
+  CHECK ((handle = open ("pages")) > 1, "open \"pages\"");
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      memset (buf, 'a' + i, PAGE_SIZE);
+      if (write (handle, buf, PAGE_SIZE) != PAGE_SIZE)
+        fail ("write page %zu failed", i);
+    }
+  CHECK (mmap (ACTUAL, FILE_PAGES * PAGE_SIZE, 0, handle, 0) != MAP_FAILED,
+         "mmap \"pages\"");
+
+  msg ("read page 0");
+  if (ACTUAL[0] != 'a')
+    fail ("page 0 has bad data");
+  check_loaded (0, WINDOW);
+
+  msg ("read page %d", WINDOW);
+  if (ACTUAL[WINDOW * PAGE_SIZE] != 'a' + WINDOW)
+    fail ("page %d has bad data", WINDOW);
+  check_loaded (0, FILE_PAGES);
+
+  msg ("check data");
+  for (i = 0; i < FILE_PAGES; i++)
+    if (ACTUAL[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) ('a' + i))
+      fail ("page %zu has bad data", i);
+}
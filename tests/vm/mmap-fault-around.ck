@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-fault-around) begin
+(mmap-fault-around) create "pages"
+(mmap-fault-around) open "pages"
+(mmap-fault-around) mmap "pages"
+(mmap-fault-around) read page 0
+(mmap-fault-around) read page 4
+(mmap-fault-around) check data
+(mmap-fault-around) end
+EOF
+pass;
@@ -0,0 +1,56 @@
+/* Exercises madvise(): MADV_WILLNEED reads a mapped file in ahead
+   of time so touching it takes no major faults, MADV_SEQUENTIAL
+   still reads the right data, MADV_DONTNEED turns dirty anonymous
+   pages back into zero pages, and an unknown advice fails. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 8
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[PAGES * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char file_buf[10016];
+
+void
+test_main (void)
+{
+  long long before;
+  int handle;
+  size_t i, size;
+
+  CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+  size = filesize (handle);
+  if (read (handle, file_buf, size) != (int) size)
+    fail ("read \"small.txt\"");
+  CHECK (mmap (ACTUAL, size, 0, handle, 0) != MAP_FAILED, "mmap \"small.txt\"");
+
+  CHECK (madvise (ACTUAL, size, MADV_WILLNEED) == 0, "madvise WILLNEED");
+  before = get_fault_stat (FAULT_MAJOR_FILE);
+  if (memcmp (ACTUAL, file_buf, size))
+    fail ("mapping differs from file after WILLNEED");
+  if (get_fault_stat (FAULT_MAJOR_FILE) != before)
+    fail ("prefetched mapping took %lld major faults",
+          get_fault_stat (FAULT_MAJOR_FILE) - before);
+  msg ("prefetched mapping without major faults");
+
+  CHECK (madvise (ACTUAL, size, MADV_DONTNEED) == 0, "madvise DONTNEED");
+  CHECK (madvise (ACTUAL, size, MADV_SEQUENTIAL) == 0, "madvise SEQUENTIAL");
+  if (memcmp (ACTUAL, file_buf, size))
+    fail ("mapping differs from file after SEQUENTIAL");
+  msg ("read mapping sequentially");
+  munmap (ACTUAL);
+
+  for (i = 0; i < PAGES; i++)
+    memset (buf + i * PAGE_SIZE, 'a' + i, PAGE_SIZE);
+  CHECK (madvise (buf, sizeof buf, MADV_DONTNEED) == 0, "madvise DONTNEED");
+  for (i = 0; i < sizeof buf; i++)
+    if (buf[i] != 0)
+      fail ("byte %zu is %d after DONTNEED", i, buf[i]);
+  msg ("dropped pages read back as zeros");
+
+  CHECK (madvise (buf, sizeof buf, 42) == -1, "madvise with bad advice");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-madvise) begin
+(mmap-madvise) open "small.txt"
+(mmap-madvise) mmap "small.txt"
+(mmap-madvise) madvise WILLNEED
+(mmap-madvise) prefetched mapping without major faults
+(mmap-madvise) madvise DONTNEED
+(mmap-madvise) madvise SEQUENTIAL
+(mmap-madvise) read mapping sequentially
+(mmap-madvise) madvise DONTNEED
+(mmap-madvise) dropped pages read back as zeros
+(mmap-madvise) madvise with bad advice
+(mmap-madvise) end
+EOF
+pass;
@@ -0,0 +1,42 @@
+/* Writes to a file through a mapping and calls msync, then reads
+   the data back with the read system call while the mapping is
+   still in place to verify that msync wrote it to the file.
+   Also checks that msync fails on an unmapped range, on a range
+   that runs past the end of the mapping, and on the stack. */
+
+#include <stdint.h>
+#include <round.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define ACTUAL ((void *) 0x10000000)
+
+void
+test_main (void)
+{
+  int handle;
+  void *map;
+  char buf[1024];
+
+  CHECK (create ("sample.txt", strlen (sample)), "create \"sample.txt\"");
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK ((map = mmap (ACTUAL, 4096, 1, handle, 0)) != MAP_FAILED, "mmap \"sample.txt\"");
+  memcpy (ACTUAL, sample, strlen (sample));
+  CHECK (msync (map, 4096) == 0, "msync \"sample.txt\"");
+
+  /* Read back via read() before unmapping. */
+  read (handle, buf, strlen (sample));
+  CHECK (!memcmp (buf, sample, strlen (sample)),
+         "compare read data against written data");
+
+  CHECK (msync ((char *) ACTUAL + 0x100000, 4096) == -1, "msync unmapped range");
+  CHECK (msync (map, 8192) == -1, "msync past end of mapping");
+  CHECK (msync (map, 0) == -1, "msync zero length");
+  CHECK (msync ((void *) ROUND_DOWN ((uintptr_t) buf, 4096), 4096) == -1,
+         "msync stack page");
+  munmap (map);
+  close (handle);
+}
@@ -0,0 +1,60 @@
+/* Maps an 8-page file writable with MAP_POPULATE and checks through
+   int 0x42 that every page is mapped before it is touched.  Then
+   writes through the mapping, unmaps it and reads the file back
+   with the read system call. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define FILE_PAGES 8
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[PAGE_SIZE];
+
+void
+test_main (void)
+{
+  int handle;
+  size_t i;
+
+  CHECK (create ("pages", FILE_PAGES * PAGE_SIZE), "create \"pages\"");
+  CHECK ((handle = open ("pages")) > 1, "open \"pages\"");
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      memset (buf, 'a' + i, PAGE_SIZE);
+      if (write (handle, buf, PAGE_SIZE) != PAGE_SIZE)
+        fail ("write page %zu failed", i);
+    }
+  CHECK (mmap (ACTUAL, FILE_PAGES * PAGE_SIZE, 1 | MAP_POPULATE, handle, 0)
+         != MAP_FAILED, "mmap \"pages\" with MAP_POPULATE");
+
+  msg ("check pages are loaded");
+  for (i = 0; i < FILE_PAGES; i++)
+    if (get_phys_addr (ACTUAL + i * PAGE_SIZE) == 0)
+      fail ("page %zu is not loaded", i);
+
+  msg ("check data");
+  for (i = 0; i < FILE_PAGES; i++)
+    if (ACTUAL[i * PAGE_SIZE] != (char) ('a' + i)
+        || ACTUAL[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) ('a' + i))
+      fail ("page %zu has bad data", i);
+
+  msg ("write through mapping");
+  for (i = 0; i < FILE_PAGES; i++)
+    ACTUAL[i * PAGE_SIZE] = 'A' + i;
+  munmap (ACTUAL);
+
+  msg ("read back");
+  seek (handle, 0);
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      if (read (handle, buf, PAGE_SIZE) != PAGE_SIZE)
+        fail ("read page %zu failed", i);
+      if (buf[0] != (char) ('A' + i) || buf[1] != (char) ('a' + i))
+        fail ("page %zu was not written back", i);
+    }
+  close (handle);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-populate) begin
+(mmap-populate) create "pages"
+(mmap-populate) open "pages"
+(mmap-populate) mmap "pages" with MAP_POPULATE
+(mmap-populate) check pages are loaded
+(mmap-populate) check data
+(mmap-populate) write through mapping
+(mmap-populate) read back
+(mmap-populate) end
+EOF
+pass;
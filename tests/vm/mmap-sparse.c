@@ -0,0 +1,53 @@
+/* Maps a one-page file with a 256 MB length, far more pages than
+   the kernel could describe one by one, and touches only a few of
+   them.  Pages past the end of the file read as zeros, and a write
+   to the first page reaches the file after munmap. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define MAP_PAGES 65536
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[PAGE_SIZE];
+
+void
+test_main (void)
+{
+  static const size_t touch[] = { 1, 4096, MAP_PAGES / 2, MAP_PAGES - 1 };
+  int handle;
+  size_t i;
+
+  CHECK (create ("sparse", PAGE_SIZE), "create \"sparse\"");
+  CHECK ((handle = open ("sparse")) > 1, "open \"sparse\"");
+  memset (buf, 'a', PAGE_SIZE);
+  CHECK (write (handle, buf, PAGE_SIZE) == PAGE_SIZE, "write \"sparse\"");
+  CHECK (mmap (ACTUAL, (size_t) MAP_PAGES * PAGE_SIZE, 1, handle, 0)
+         != MAP_FAILED, "mmap \"sparse\" with 256 MB length");
+
+  msg ("check first page");
+  if (ACTUAL[0] != 'a' || ACTUAL[PAGE_SIZE - 1] != 'a')
+    fail ("first page has bad data");
+
+  msg ("check pages past end of file");
+  for (i = 0; i < sizeof touch / sizeof *touch; i++)
+    {
+      char *page = ACTUAL + touch[i] * PAGE_SIZE;
+      if (page[0] != 0 || page[PAGE_SIZE - 1] != 0)
+        fail ("page %zu is not zero", touch[i]);
+    }
+
+  msg ("write first page");
+  ACTUAL[0] = 'A';
+  munmap (ACTUAL);
+
+  msg ("read back");
+  seek (handle, 0);
+  CHECK (read (handle, buf, PAGE_SIZE) == PAGE_SIZE, "read \"sparse\"");
+  if (buf[0] != 'A' || buf[1] != 'a')
+    fail ("first page was not written back");
+  close (handle);
+}
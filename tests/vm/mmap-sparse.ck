@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-sparse) begin
+(mmap-sparse) create "sparse"
+(mmap-sparse) open "sparse"
+(mmap-sparse) write "sparse"
+(mmap-sparse) mmap "sparse" with 256 MB length
+(mmap-sparse) check first page
+(mmap-sparse) check pages past end of file
+(mmap-sparse) write first page
+(mmap-sparse) read back
+(mmap-sparse) read "sparse"
+(mmap-sparse) end
+EOF
+pass;
@@ -0,0 +1,66 @@
+/* Touches a small "hot" working set after every few pages of a
+   long "cold" scan and counts the major faults taken on the hot
+   set through the VM inspect interrupt (int 0x45).
+
+   A second-chance (clock) replacement policy keeps the hot pages
+   resident because their accessed bits are always set when the
+   hand reaches them.  With FIFO replacement (-evict=fifo) every hot
+   page is evicted once per trip through the frame table, so this
+   test doubles as a benchmark: run it under both policies and
+   compare the "VM: N major faults" line printed at shutdown.
+   For this test, Pintos memory size is 10MB. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define ONE_MB (1 << 20)
+#define COLD_SIZE (16 * ONE_MB)
+#define COLD_PAGES (COLD_SIZE / PAGE_SIZE)
+#define HOT_PAGES 32
+#define HOT_INTERVAL 32
+
+static char cold[COLD_SIZE];
+static char hot[HOT_PAGES * PAGE_SIZE];
+
+static void
+touch_hot (void)
+{
+  size_t i;
+
+  for (i = 0; i < HOT_PAGES; i++)
+    hot[i * PAGE_SIZE]++;
+}
+
+void
+test_main (void)
+{
+  long long hot_faults = 0;
+  size_t i;
+
+  msg ("warm up hot set");
+  touch_hot ();
+
+  msg ("scan cold pages");
+  for (i = 0; i < COLD_PAGES; i++)
+    {
+      cold[i * PAGE_SIZE] = (char) i;
+      if (i % HOT_INTERVAL == 0)
+        {
+          long long before = get_major_fault_cnt ();
+          touch_hot ();
+          hot_faults += get_major_fault_cnt () - before;
+        }
+    }
+
+  msg ("check hot set");
+  for (i = 0; i < HOT_PAGES; i++)
+    if (hot[i * PAGE_SIZE] != (char) (COLD_PAGES / HOT_INTERVAL + 1))
+      fail ("hot page %zu is inconsistent", i);
+
+  if (hot_faults >= HOT_PAGES)
+    fail ("hot set took %lld major faults", hot_faults);
+  msg ("hot set stayed resident");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-clock) begin
+(page-clock) warm up hot set
+(page-clock) scan cold pages
+(page-clock) check hot set
+(page-clock) hot set stayed resident
+(page-clock) end
+EOF
+pass;
@@ -0,0 +1,75 @@
+/* Forks after filling a buffer and checks that the parent and
+   child each see their own copy once either side writes to it.
+   The child also read()s a file into the shared buffer, which
+   must not leak into the parent's copy either. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 64
+
+static char buf[PAGE_CNT * PAGE_SIZE];
+
+/* Returns true if every byte of page I of BUF equals C. */
+static bool
+page_is (size_t i, char c)
+{
+  size_t j;
+
+  for (j = 0; j < PAGE_SIZE; j++)
+    if (buf[i * PAGE_SIZE + j] != c)
+      return false;
+  return true;
+}
+
+void
+test_main (void)
+{
+  pid_t child;
+  int handle;
+  size_t i;
+
+  msg ("fill buffer");
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf + i * PAGE_SIZE, 'a' + i % 26, PAGE_SIZE);
+
+  child = fork ("page-cow");
+  if (child == 0)
+    {
+      for (i = 0; i < PAGE_CNT; i++)
+        if (!page_is (i, 'a' + i % 26))
+          fail ("child sees bad data in page %zu", i);
+
+      /* Write every other page from user mode... */
+      for (i = 0; i < PAGE_CNT; i += 2)
+        memset (buf + i * PAGE_SIZE, 'X', PAGE_SIZE);
+
+      /* ...and one more through the kernel. */
+      if ((handle = open ("sample.txt")) < 2)
+        fail ("child: open \"sample.txt\"");
+      if (read (handle, buf + PAGE_SIZE, sizeof sample - 1)
+          != (int) sizeof sample - 1)
+        fail ("child: read \"sample.txt\"");
+      if (memcmp (buf + PAGE_SIZE, sample, sizeof sample - 1))
+        fail ("child: read data mismatch");
+      close (handle);
+      exit (42);
+    }
+
+  CHECK (wait (child) == 42, "wait for child");
+  for (i = 0; i < PAGE_CNT; i++)
+    if (!page_is (i, 'a' + i % 26))
+      fail ("parent sees child's write in page %zu", i);
+  msg ("parent's copy unchanged");
+
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf + i * PAGE_SIZE, 'Y', PAGE_SIZE);
+  for (i = 0; i < PAGE_CNT; i++)
+    if (!page_is (i, 'Y'))
+      fail ("parent lost its own write in page %zu", i);
+  msg ("parent writes after fork");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-cow) begin
+(page-cow) fill buffer
+(page-cow) wait for child
+(page-cow) parent's copy unchanged
+(page-cow) parent writes after fork
+(page-cow) end
+EOF
+pass;
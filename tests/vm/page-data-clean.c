@@ -0,0 +1,52 @@
+/* Reads an initialized data array larger than the process's
+   resident set limit, so that clean data pages are dropped and
+   read back from the executable, then writes to every page and
+   checks that the modified contents survive eviction to swap. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 64
+#define LIMIT 16
+
+#define MARK(N) [(N) * PAGE_SIZE] = (N) + 1, [(N) * PAGE_SIZE + PAGE_SIZE - 1] = (N) + 1
+#define MARK8(N) MARK (N), MARK (N + 1), MARK (N + 2), MARK (N + 3),    \
+                 MARK (N + 4), MARK (N + 5), MARK (N + 6), MARK (N + 7)
+
+static char data[PAGES * PAGE_SIZE] =
+  {
+    MARK8 (0), MARK8 (8), MARK8 (16), MARK8 (24),
+    MARK8 (32), MARK8 (40), MARK8 (48), MARK8 (56),
+  };
+
+static void
+check (int delta, const char *what)
+{
+  int pass, i;
+
+  for (pass = 0; pass < 2; pass++)
+    for (i = 0; i < PAGES; i++)
+      if (data[i * PAGE_SIZE] != (char) (i + 1 + delta)
+          || data[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) (i + 1 + delta))
+        fail ("%s page %d is inconsistent", what, i);
+  msg ("read %s data twice", what);
+}
+
+void
+test_main (void)
+{
+  int i;
+
+  rss_limit (LIMIT);
+  check (0, "initialized");
+
+  for (i = 0; i < PAGES; i++)
+    {
+      data[i * PAGE_SIZE] += 100;
+      data[i * PAGE_SIZE + PAGE_SIZE - 1] += 100;
+    }
+  check (100, "modified");
+}
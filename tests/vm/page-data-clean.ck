@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-data-clean) begin
+(page-data-clean) read initialized data twice
+(page-data-clean) read modified data twice
+(page-data-clean) end
+EOF
+pass;
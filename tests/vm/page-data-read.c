@@ -0,0 +1,63 @@
+/* Reads a file straight into initialized data and BSS pages that
+   the process has never touched, with the read system call, then
+   pushes the pages out under a small resident set limit and
+   checks that the file contents, not the executable's, come back. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 32
+#define LIMIT 8
+
+static char data[PAGES * PAGE_SIZE] = { 1 };
+static char bss[PAGES * PAGE_SIZE];
+static char page_buf[PAGE_SIZE];
+
+static char
+pattern (int i)
+{
+  return i * 7 + 3;
+}
+
+static void
+check (const char *buf, const char *what)
+{
+  int pass, i;
+
+  for (pass = 0; pass < 2; pass++)
+    for (i = 0; i < PAGES; i++)
+      if (buf[i * PAGE_SIZE] != pattern (i)
+          || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != pattern (i))
+        fail ("%s page %d is inconsistent", what, i);
+  msg ("%s pages survived eviction", what);
+}
+
+void
+test_main (void)
+{
+  int handle, i;
+
+  CHECK (create ("data.bin", 0), "create \"data.bin\"");
+  CHECK ((handle = open ("data.bin")) > 1, "open \"data.bin\"");
+  for (i = 0; i < PAGES; i++)
+    {
+      memset (page_buf, pattern (i), PAGE_SIZE);
+      if (write (handle, page_buf, PAGE_SIZE) != PAGE_SIZE)
+        fail ("write page %d failed", i);
+    }
+
+  rss_limit (LIMIT);
+  seek (handle, 0);
+  CHECK (read (handle, data, sizeof data) == (int) sizeof data,
+         "read into data");
+  seek (handle, 0);
+  CHECK (read (handle, bss, sizeof bss) == (int) sizeof bss,
+         "read into bss");
+  close (handle);
+
+  check (data, "data");
+  check (bss, "bss");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-data-read) begin
+(page-data-read) create "data.bin"
+(page-data-read) open "data.bin"
+(page-data-read) read into data
+(page-data-read) read into bss
+(page-data-read) data pages survived eviction
+(page-data-read) bss pages survived eviction
+(page-data-read) end
+EOF
+pass;
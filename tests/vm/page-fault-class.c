@@ -0,0 +1,83 @@
+/* Checks the per-process page fault classes reported through
+   int 0x47: reading untouched zero-filled pages takes minor faults,
+   writing them afterwards takes write-protect faults, touching a
+   large stack array grows the stack, and reading a mapped file
+   takes a major fault from the file. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 16
+#define ACTUAL ((char *) 0x10000000)
+
+static char buf[PAGES * PAGE_SIZE];
+
+/* Returns how many faults of class WHICH BEFORE is behind. */
+static long long
+delta (enum fault_stat which, long long before)
+{
+  return get_fault_stat (which) - before;
+}
+
+/* Writes one byte to every page of a large stack array, from the
+   top down, and returns the byte written to the lowest page. */
+static int __attribute__ ((noinline))
+touch_stack (void)
+{
+  volatile char big[PAGES * PAGE_SIZE];
+  int i;
+
+  for (i = PAGES - 1; i >= 0; i--)
+    big[i * PAGE_SIZE] = i;
+  return big[0];
+}
+
+void
+test_main (void)
+{
+  long long before;
+  int handle;
+  size_t i;
+
+  before = get_fault_stat (FAULT_MINOR);
+  for (i = 0; i < PAGES; i++)
+    if (buf[i * PAGE_SIZE] != 0)
+      fail ("page %zu is not zero", i);
+  if (delta (FAULT_MINOR, before) < PAGES - 1)
+    fail ("reading zero pages took %lld minor faults",
+          delta (FAULT_MINOR, before));
+  msg ("minor faults on zero pages");
+
+  before = get_fault_stat (FAULT_WP);
+  for (i = 0; i < PAGES; i++)
+    buf[i * PAGE_SIZE] = 'x';
+  if (delta (FAULT_WP, before) < PAGES - 1)
+    fail ("writing zero pages took %lld write-protect faults",
+          delta (FAULT_WP, before));
+  msg ("write-protect faults on zero pages");
+
+  before = get_fault_stat (FAULT_STACK);
+  if (touch_stack () != 0)
+    fail ("stack array lost a write");
+  if (delta (FAULT_STACK, before) < PAGES / 2)
+    fail ("stack array took %lld stack growth faults",
+          delta (FAULT_STACK, before));
+  msg ("stack growth faults");
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (ACTUAL, 4096, 0, handle, 0) != MAP_FAILED, "mmap \"sample.txt\"");
+  before = get_fault_stat (FAULT_MAJOR_FILE);
+  if (ACTUAL[0] == 0)
+    fail ("mapped file starts with a zero byte");
+  if (delta (FAULT_MAJOR_FILE, before) < 1)
+    fail ("reading the mapping took no major file fault");
+  msg ("major fault from file");
+
+  if (get_fault_stat (FAULT_INVALID) != 0)
+    fail ("%lld invalid faults", get_fault_stat (FAULT_INVALID));
+  munmap (ACTUAL);
+  close (handle);
+}
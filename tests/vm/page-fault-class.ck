@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-fault-class) begin
+(page-fault-class) minor faults on zero pages
+(page-fault-class) write-protect faults on zero pages
+(page-fault-class) stack growth faults
+(page-fault-class) open "sample.txt"
+(page-fault-class) mmap "sample.txt"
+(page-fault-class) major fault from file
+(page-fault-class) end
+EOF
+pass;
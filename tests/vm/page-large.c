@@ -0,0 +1,59 @@
+/* Writes to every page of a 2 MB aligned region inside a large
+   zero-filled array with the kernel's -large-pages option on.  The
+   first fault must map the whole region with one 2 MB page, so the
+   frames behind it (seen through int 0x42) are physically
+   contiguous and 2 MB aligned.  A forked child then writes to the
+   region, which splits the parent's large page for copy-on-write,
+   and both processes must still see their own data. */
+
+#include <stdint.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define LARGE_SIZE (2 * 1024 * 1024)
+#define LARGE_PAGES (LARGE_SIZE / PAGE_SIZE)
+
+static char buf[2 * LARGE_SIZE];
+
+void
+test_main (void)
+{
+  char *region = (char *) (((uintptr_t) buf + LARGE_SIZE - 1)
+                           & ~(uintptr_t) (LARGE_SIZE - 1));
+  uintptr_t base;
+  pid_t child;
+  size_t i;
+
+  msg ("write region");
+  for (i = 0; i < LARGE_PAGES; i++)
+    region[i * PAGE_SIZE] = (char) i;
+
+  msg ("check physical layout");
+  base = (uintptr_t) get_phys_addr (region);
+  if (base % LARGE_SIZE != 0)
+    fail ("region is not backed by an aligned large page");
+  for (i = 0; i < LARGE_PAGES; i++)
+    if ((uintptr_t) get_phys_addr (region + i * PAGE_SIZE)
+        != base + i * PAGE_SIZE)
+      fail ("page %zu is not contiguous with the large page", i);
+
+  child = fork ("child");
+  if (child == 0)
+    {
+      for (i = 0; i < LARGE_PAGES; i++)
+        region[i * PAGE_SIZE] = 'c';
+      for (i = 0; i < LARGE_PAGES; i++)
+        if (region[i * PAGE_SIZE] != 'c')
+          fail ("child page %zu is inconsistent", i);
+      exit (0);
+    }
+  CHECK (wait (child) == 0, "wait for child");
+
+  msg ("check region");
+  for (i = 0; i < LARGE_PAGES; i++)
+    if (region[i * PAGE_SIZE] != (char) i)
+      fail ("page %zu is inconsistent", i);
+}
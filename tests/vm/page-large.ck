@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-large) begin
+(page-large) write region
+(page-large) check physical layout
+(page-large) wait for child
+(page-large) check region
+(page-large) end
+EOF
+pass;
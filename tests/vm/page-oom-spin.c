@@ -0,0 +1,55 @@
+/* Forks a child that fills most of memory and then spins in
+   user mode without faulting or making system calls, and a
+   second child that needs more memory than is left.  Checks
+   that the out-of-memory killer chooses the spinning child,
+   that the kill reaches it from the timer interrupt, and that
+   the second child then completes. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define HOG_PAGES 300
+#define ALLOC_PAGES 300
+
+static char big[HOG_PAGES * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  pid_t hog, alloc;
+  size_t i;
+  int fd;
+
+  hog = fork ("hog");
+  if (hog == 0)
+    {
+      volatile int spin = 0;
+
+      for (i = 0; i < HOG_PAGES; i++)
+        big[i * PAGE_SIZE] = i % 251 + 1;
+      create ("hog-ready", 0);
+      for (;;)
+        spin++;
+    }
+  CHECK (hog > 0, "fork hog");
+  while ((fd = open ("hog-ready")) < 0)
+    continue;
+  close (fd);
+
+  alloc = fork ("alloc");
+  if (alloc == 0)
+    {
+      for (i = 0; i < ALLOC_PAGES; i++)
+        big[i * PAGE_SIZE] = i % 251 + 1;
+      for (i = 0; i < ALLOC_PAGES; i++)
+        if (big[i * PAGE_SIZE] != (char) (i % 251 + 1))
+          fail ("page %zu is corrupted", i);
+      exit (81);
+    }
+  CHECK (alloc > 0, "fork alloc");
+  CHECK (wait (alloc) == 81, "allocating child survived");
+  CHECK (wait (hog) == -1, "spinning child was killed");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-oom-spin) begin
+(page-oom-spin) fork hog
+(page-oom-spin) fork alloc
+(page-oom-spin) allocating child survived
+(page-oom-spin) spinning child was killed
+(page-oom-spin) end
+EOF
+pass;
@@ -0,0 +1,42 @@
+/* Forks a child that writes more memory than physical memory
+   and swap can hold together, and checks that the out-of-memory
+   killer terminates the child instead of the kernel panicking,
+   while the parent's own memory stays intact. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHILD_PAGES 4096
+#define PARENT_PAGES 16
+
+static char big[CHILD_PAGES * PAGE_SIZE];
+static char small[PARENT_PAGES * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  pid_t pid;
+  size_t i;
+
+  for (i = 0; i < PARENT_PAGES; i++)
+    memset (small + i * PAGE_SIZE, i + 1, PAGE_SIZE);
+
+  pid = fork ("child");
+  if (pid == 0)
+    {
+      for (i = 0; i < CHILD_PAGES; i++)
+        big[i * PAGE_SIZE] = i % 251 + 1;
+      exit (0);
+    }
+  CHECK (pid > 0, "fork");
+  CHECK (wait (pid) == -1, "child was killed");
+
+  for (i = 0; i < PARENT_PAGES; i++)
+    if (small[i * PAGE_SIZE] != (char) (i + 1)
+        || small[(i + 1) * PAGE_SIZE - 1] != (char) (i + 1))
+      fail ("parent page %zu is corrupted", i);
+  msg ("parent survived");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-oom) begin
+(page-oom) fork
+(page-oom) child was killed
+(page-oom) parent survived
+(page-oom) end
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Writes a buffer larger than physical memory and checks that the
+   background reclaim daemon kept the free user frame count up:
+   it must have been woken, it must have freed frames ahead of the
+   faults, and every page must still read back correctly.
+   For this test, Pintos memory size is 10MB. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define ONE_MB (1 << 20)
+#define BUF_SIZE (16 * ONE_MB)
+#define BUF_PAGES (BUF_SIZE / PAGE_SIZE)
+
+static char buf[BUF_SIZE];
+
+void
+test_main (void)
+{
+  long long low = get_reclaim_stat (RECLAIM_WMARK_LOW);
+  long long high = get_reclaim_stat (RECLAIM_WMARK_HIGH);
+  size_t i;
+
+  if (low <= 0 || high <= low)
+    fail ("bad watermarks: low %lld, high %lld", low, high);
+
+  msg ("write pages");
+  for (i = 0; i < BUF_PAGES; i++)
+    buf[i * PAGE_SIZE] = (char) i;
+
+  msg ("check pages");
+  for (i = 0; i < BUF_PAGES; i++)
+    if (buf[i * PAGE_SIZE] != (char) i)
+      fail ("page %zu is inconsistent", i);
+
+  if (get_reclaim_stat (RECLAIM_WAKEUPS) == 0)
+    fail ("reclaim daemon never woke up");
+  if (get_reclaim_stat (RECLAIM_RECLAIMED) == 0)
+    fail ("reclaim daemon freed no frames");
+  msg ("reclaim daemon ran");
+}
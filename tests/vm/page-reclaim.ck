@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-reclaim) begin
+(page-reclaim) write pages
+(page-reclaim) check pages
+(page-reclaim) reclaim daemon ran
+(page-reclaim) end
+EOF
+pass;
@@ -0,0 +1,44 @@
+/* Limits the process to 64 resident pages, then writes and reads
+   back a 2 MB array.  The pages must survive being pushed out to
+   swap, and the process must never hold more frames than its
+   limit allows. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 512
+#define LIMIT 64
+
+static char buf[PAGES * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  size_t i, peak = 0;
+
+  rss_limit (LIMIT);
+  msg ("set limit of %d pages", LIMIT);
+
+  for (i = 0; i < PAGES; i++)
+    {
+      memset (buf + i * PAGE_SIZE, i % 251, PAGE_SIZE);
+      if (resident_set () > peak)
+        peak = resident_set ();
+    }
+  for (i = 0; i < PAGES; i++)
+    {
+      if (buf[i * PAGE_SIZE] != (char) (i % 251)
+          || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) (i % 251))
+        fail ("page %zu is inconsistent", i);
+      if (resident_set () > peak)
+        peak = resident_set ();
+    }
+  msg ("wrote and read back %d pages", PAGES);
+
+  if (peak > LIMIT)
+    fail ("resident set reached %zu pages", peak);
+  msg ("resident set stayed within limit");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-rss-limit) begin
+(page-rss-limit) set limit of 64 pages
+(page-rss-limit) wrote and read back 512 pages
+(page-rss-limit) resident set stayed within limit
+(page-rss-limit) end
+EOF
+pass;
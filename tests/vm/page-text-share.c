@@ -0,0 +1,56 @@
+/* Runs this program a second time while the first copy waits for
+   it, so that two processes map the code of the same executable.
+   The second copy checks that its code pages were shared with the
+   first one, then writes more memory than the user pool holds so
+   that the shared code frames have to be evicted from both
+   processes.  Both copies must still run their code afterwards. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 512
+
+static char buf[PAGES * PAGE_SIZE];
+
+static void
+fill_memory (void)
+{
+  size_t i;
+
+  for (i = 0; i < PAGES; i++)
+    buf[i * PAGE_SIZE] = i % 251 + 1;
+  for (i = 0; i < PAGES; i++)
+    if (buf[i * PAGE_SIZE] != (char) (i % 251 + 1))
+      fail ("page %zu is inconsistent", i);
+}
+
+int
+main (int argc, char *argv[] UNUSED)
+{
+  pid_t pid;
+
+  test_name = "page-text-share";
+
+  if (argc > 1)
+    {
+      CHECK (get_reclaim_stat (RECLAIM_TEXT_SHARES) > 0,
+             "code shared with parent");
+      fill_memory ();
+      CHECK (get_reclaim_stat (RECLAIM_SHARED_EVICTIONS) > 0,
+             "shared frames evicted");
+      return 81;
+    }
+
+  msg ("begin");
+  pid = fork ("child");
+  if (pid == 0)
+    {
+      exec ("page-text-share child");
+      fail ("exec \"page-text-share child\"");
+    }
+  CHECK (pid > 0, "fork");
+  CHECK (wait (pid) == 81, "wait for child");
+  msg ("end");
+  return 0;
+}
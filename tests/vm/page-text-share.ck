@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-text-share) begin
+(page-text-share) fork
+(page-text-share) code shared with parent
+(page-text-share) shared frames evicted
+(page-text-share) wait for child
+(page-text-share) end
+EOF
+pass;
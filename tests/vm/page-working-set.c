@@ -0,0 +1,64 @@
+/* Keeps writing to 64 pages until the working-set estimate reported
+   by the working_set system call covers most of them, then touches
+   only 4 of those pages until the estimate decays back down.  The
+   kernel samples accessed bits a few times per second, so both
+   phases loop for a bounded number of rounds instead of a fixed
+   time. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 64
+#define SMALL_PAGES 4
+#define MAX_ROUNDS (1 << 22)
+
+static char buf[PAGES * PAGE_SIZE];
+
+/* Writes to the first PAGE_CNT pages of BUF until the working-set
+   estimate satisfies DONE, or gives up after MAX_ROUNDS rounds.
+   Returns the last estimate. */
+static size_t
+touch_until (size_t page_cnt, bool (*done) (size_t))
+{
+  size_t round, i, estimate = working_set ();
+
+  for (round = 0; round < MAX_ROUNDS && !done (estimate); round++)
+    {
+      for (i = 0; i < page_cnt; i++)
+        buf[i * PAGE_SIZE] = round;
+      estimate = working_set ();
+    }
+  return estimate;
+}
+
+static bool
+grown (size_t estimate)
+{
+  return estimate >= PAGES / 2;
+}
+
+static bool
+shrunk (size_t estimate)
+{
+  return estimate < PAGES / 4;
+}
+
+void
+test_main (void)
+{
+  size_t estimate;
+
+  estimate = touch_until (PAGES, grown);
+  if (!grown (estimate))
+    fail ("working set stayed at %zu pages while touching %d",
+          estimate, PAGES);
+  msg ("working set grows");
+
+  estimate = touch_until (SMALL_PAGES, shrunk);
+  if (!shrunk (estimate))
+    fail ("working set stayed at %zu pages while touching %d",
+          estimate, SMALL_PAGES);
+  msg ("working set decays");
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-working-set) begin
+(page-working-set) working set grows
+(page-working-set) working set decays
+(page-working-set) end
+EOF
+pass;
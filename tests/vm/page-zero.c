@@ -0,0 +1,56 @@
+/* Reads every page of a zero-filled array larger than physical
+   memory twice, then writes a few pages.  Untouched anonymous pages
+   that are only read are backed by the shared zero frame, so the
+   reads must not evict anything: the second pass takes no major
+   faults (int 0x45).  Writes must still get private pages.
+   For this test, Pintos memory size is 10MB. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define ONE_MB (1 << 20)
+#define BUF_SIZE (16 * ONE_MB)
+#define BUF_PAGES (BUF_SIZE / PAGE_SIZE)
+#define WRITE_STRIDE 64
+
+static char buf[BUF_SIZE];
+
+static void
+read_all (void)
+{
+  size_t i;
+
+  for (i = 0; i < BUF_PAGES; i++)
+    if (buf[i * PAGE_SIZE] != 0)
+      fail ("page %zu is not zero", i);
+}
+
+void
+test_main (void)
+{
+  long long faults;
+  size_t i;
+
+  msg ("read zero pages");
+  read_all ();
+  faults = get_major_fault_cnt ();
+  read_all ();
+  if (get_major_fault_cnt () != faults)
+    fail ("rereading zero pages took %lld major faults",
+          get_major_fault_cnt () - faults);
+
+  msg ("write some pages");
+  for (i = 0; i < BUF_PAGES; i += WRITE_STRIDE)
+    buf[i * PAGE_SIZE + 1] = 'x';
+
+  msg ("check pages");
+  for (i = 0; i < BUF_PAGES; i++)
+    {
+      char expected = i % WRITE_STRIDE == 0 ? 'x' : 0;
+      if (buf[i * PAGE_SIZE] != 0 || buf[i * PAGE_SIZE + 1] != expected)
+        fail ("page %zu is inconsistent", i);
+    }
+}
@@ -0,0 +1,66 @@
+/* Pushes a 1 MB array through swap several times while only
+   reading it, so that clean pages are evicted again without
+   being rewritten, then modifies every other page and checks
+   that the new contents rather than the stale swap copies come
+   back. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 256
+#define LIMIT 32
+
+static unsigned char buf[PAGES * PAGE_SIZE];
+
+/* Fills or checks page I with a pseudo-random sequence seeded by
+   I and GEN, so that the page does not compress. */
+static bool
+page_pattern (size_t i, unsigned gen, bool fill)
+{
+  unsigned char *p = buf + i * PAGE_SIZE;
+  unsigned x = i * 2654435761u + gen;
+  size_t j;
+
+  for (j = 0; j < PAGE_SIZE; j++)
+    {
+      x = x * 1103515245 + 12345;
+      if (fill)
+        p[j] = x >> 16;
+      else if (p[j] != (unsigned char) (x >> 16))
+        return false;
+    }
+  return true;
+}
+
+static void
+check (int round)
+{
+  size_t i;
+
+  for (i = 0; i < PAGES; i++)
+    if (!page_pattern (i, round > 0 && i % 2 == 0, false))
+      fail ("page %zu is inconsistent in round %d", i, round);
+}
+
+void
+test_main (void)
+{
+  size_t i;
+  int round;
+
+  rss_limit (LIMIT);
+  for (i = 0; i < PAGES; i++)
+    page_pattern (i, 0, true);
+  for (round = 0; round < 3; round++)
+    check (0);
+  msg ("read back %d pages three times", PAGES);
+
+  for (i = 0; i < PAGES; i += 2)
+    page_pattern (i, 1, true);
+  for (round = 1; round < 3; round++)
+    check (round);
+  msg ("modified pages survived eviction");
+}
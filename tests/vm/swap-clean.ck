@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-clean) begin
+(swap-clean) read back 256 pages three times
+(swap-clean) modified pages survived eviction
+(swap-clean) end
+EOF
+pass;
@@ -0,0 +1,33 @@
+/* Runs with the swap disk given explicitly on the kernel command
+   line (-swap=1:1:2) instead of the built-in default, writes an
+   array larger than the process's resident set limit and checks
+   that every page comes back from swap intact. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 256
+#define LIMIT 16
+
+static char buf[PAGES * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  int round;
+  size_t i;
+
+  rss_limit (LIMIT);
+  for (i = 0; i < PAGES; i++)
+    memset (buf + i * PAGE_SIZE, i % 251 + 1, PAGE_SIZE);
+
+  for (round = 0; round < 2; round++)
+    for (i = 0; i < PAGES; i++)
+      if (buf[i * PAGE_SIZE] != (char) (i % 251 + 1)
+          || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) (i % 251 + 1))
+        fail ("page %zu is inconsistent in round %d", i, round);
+  msg ("%d pages survived swapping twice", PAGES);
+}
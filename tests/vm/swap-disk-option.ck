@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-disk-option) begin
+(swap-disk-option) 256 pages survived swapping twice
+(swap-disk-option) end
+EOF
+pass;
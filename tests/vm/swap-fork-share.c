@@ -0,0 +1,86 @@
+/* Pushes most of an array out to swap, then forks so that parent
+   and child share the swap slots of the evicted pages.  The child
+   reads every page back and overwrites half of them; afterwards
+   the parent must still see its own contents, which exercises the
+   reference counts on shared swap slots. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 128
+#define LIMIT 16
+
+static char buf[PAGES * PAGE_SIZE];
+
+static char
+pattern (size_t i, int gen)
+{
+  return i * 7 + gen * 31 + 1;
+}
+
+static void
+fill (size_t i, int gen)
+{
+  memset (buf + i * PAGE_SIZE, pattern (i, gen), PAGE_SIZE);
+}
+
+/* Checks that page I holds the value for GEN in every byte. */
+static bool
+page_ok (size_t i, int gen)
+{
+  const char *p = buf + i * PAGE_SIZE;
+  size_t j;
+
+  for (j = 0; j < PAGE_SIZE; j++)
+    if (p[j] != pattern (i, gen))
+      return false;
+  return true;
+}
+
+/* Reads the whole array twice, expecting generation ODD_GEN in
+   odd pages and EVEN_GEN in even pages. */
+static void
+check (int even_gen, int odd_gen, const char *who)
+{
+  int pass;
+  size_t i;
+
+  for (pass = 0; pass < 2; pass++)
+    for (i = 0; i < PAGES; i++)
+      if (!page_ok (i, i % 2 ? odd_gen : even_gen))
+        fail ("%s: page %zu is inconsistent", who, i);
+}
+
+void
+test_main (void)
+{
+  pid_t pid;
+  size_t i;
+
+  rss_limit (LIMIT);
+  for (i = 0; i < PAGES; i++)
+    fill (i, 0);
+
+  pid = fork ("child");
+  if (pid == 0)
+    {
+      check (0, 0, "child");
+      for (i = 0; i < PAGES; i += 2)
+        fill (i, 1);
+      check (1, 0, "child");
+      msg ("child rewrote even pages");
+      exit (81);
+    }
+  CHECK (pid > 0, "fork");
+  CHECK (wait (pid) == 81, "wait for child");
+
+  check (0, 0, "parent");
+  msg ("parent pages unchanged");
+  for (i = 1; i < PAGES; i += 2)
+    fill (i, 2);
+  check (0, 2, "parent");
+  msg ("parent rewrote odd pages");
+}
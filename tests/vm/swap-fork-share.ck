@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-fork-share) begin
+(swap-fork-share) fork
+(swap-fork-share) child rewrote even pages
+(swap-fork-share) wait for child
+(swap-fork-share) parent pages unchanged
+(swap-fork-share) parent rewrote odd pages
+(swap-fork-share) end
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* Runs two processes that each write more memory than half of
+   the user pool, so that evictions keep writing pages to swap
+   while the other process (and the reclaim daemon) keeps
+   faulting.  Evictions drop the frame lock while their swap
+   writes are on the disk, so some page faults must be handled
+   during those writes.  Both processes then read their pages
+   back to check that nothing was lost in transit. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 256
+
+static char buf[PAGES * PAGE_SIZE];
+
+static char
+pattern (size_t i, int who)
+{
+  return i * 3 + who * 101 + 1;
+}
+
+/* Writes every page of BUF, then checks all of them. */
+static void
+thrash (int who, const char *name)
+{
+  size_t i;
+
+  for (i = 0; i < PAGES; i++)
+    {
+      buf[i * PAGE_SIZE] = pattern (i, who);
+      buf[i * PAGE_SIZE + PAGE_SIZE - 1] = pattern (i, who);
+    }
+  for (i = 0; i < PAGES; i++)
+    if (buf[i * PAGE_SIZE] != pattern (i, who)
+        || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != pattern (i, who))
+      fail ("%s: page %zu is inconsistent", name, i);
+}
+
+void
+test_main (void)
+{
+  pid_t pid;
+
+  pid = fork ("child");
+  if (pid == 0)
+    {
+      thrash (1, "child");
+      exit (81);
+    }
+  CHECK (pid > 0, "fork");
+  thrash (0, "parent");
+  CHECK (wait (pid) == 81, "wait for child");
+  CHECK (get_reclaim_stat (RECLAIM_SWAP_OUT_OVERLAPS) > 0,
+         "faults handled during swap-out writes");
+}
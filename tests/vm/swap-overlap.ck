@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-overlap) begin
+(swap-overlap) fork
+(swap-overlap) wait for child
+(swap-overlap) faults handled during swap-out writes
+(swap-overlap) end
+EOF
+pass;
@@ -0,0 +1,44 @@
+/* Writes an array larger than the process's resident set limit so
+   that its pages go to neighbouring swap slots, then reads it back
+   in order.  Each read from the swap disk should bring the
+   following slots into the swap cache, so most of the later
+   swap-ins must be served from the cache (int 0x46). */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGES 256
+#define LIMIT 16
+
+static char buf[PAGES * PAGE_SIZE];
+
+void
+test_main (void)
+{
+  long long readaheads, hits;
+  size_t i;
+
+  rss_limit (LIMIT);
+  for (i = 0; i < PAGES; i++)
+    memset (buf + i * PAGE_SIZE, i % 251 + 1, PAGE_SIZE);
+  msg ("wrote %d pages", PAGES);
+
+  readaheads = get_reclaim_stat (RECLAIM_SWAP_READAHEADS);
+  hits = get_reclaim_stat (RECLAIM_SWAP_CACHE_HITS);
+  for (i = 0; i < PAGES; i++)
+    if (buf[i * PAGE_SIZE] != (char) (i % 251 + 1)
+        || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) (i % 251 + 1))
+      fail ("page %zu is inconsistent", i);
+  msg ("read back %d pages in order", PAGES);
+
+  readaheads = get_reclaim_stat (RECLAIM_SWAP_READAHEADS) - readaheads;
+  hits = get_reclaim_stat (RECLAIM_SWAP_CACHE_HITS) - hits;
+  if (readaheads < PAGES / 2)
+    fail ("only %lld pages were read ahead", readaheads);
+  if (hits < PAGES / 2)
+    fail ("only %lld swap-ins hit the swap cache", hits);
+  msg ("sequential swap-in hit the swap cache");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(swap-readahead) begin
+(swap-readahead) wrote 256 pages
+(swap-readahead) read back 256 pages in order
+(swap-readahead) sequential swap-in hit the swap cache
+(swap-readahead) end
+EOF
+pass;
@@ -0,0 +1,43 @@
+/* Swaps out a mix of highly compressible pages and incompressible
+ * pages through a small compressed swap pool (-zswap=64), so that
+ * some pages stay compressed in memory, some spill to the swap disk
+ * and some bypass the pool, then checks that every page comes back
+ * intact. */
+
+#include <string.h>
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_SIZE (20 * 1024 * 1024)
+#define PAGE_COUNT (CHUNK_SIZE / PAGE_SIZE)
+
+static char big_chunks[CHUNK_SIZE];
+
+/* Fills page I. Even pages are mostly zero, odd pages are noise. */
+static char
+page_byte (size_t i, size_t ofs)
+{
+  if (i % 2 == 0)
+    return ofs % 512 == 0 ? (char) (i + ofs / 512) : 0;
+  return (char) ((i * 2654435761u + ofs * 40503u) >> 13);
+}
+
+void
+test_main (void)
+{
+  size_t i, ofs;
+
+  msg ("write pages");
+  for (i = 0; i < PAGE_COUNT; i++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      big_chunks[i * PAGE_SIZE + ofs] = page_byte (i, ofs);
+
+  msg ("check pages");
+  for (i = 0; i < PAGE_COUNT; i++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (big_chunks[i * PAGE_SIZE + ofs] != page_byte (i, ofs))
+        fail ("page %zu is inconsistent at offset %zu", i, ofs);
+}
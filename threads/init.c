@@ -31,6 +31,7 @@
 #include "tests/threads/tests.h"
 #ifdef VM
 #include "vm/vm.h"
+#include "vm/zswap.h"
 #endif
 #ifdef FILESYS
 #include "devices/disk.h"
@@ -60,6 +61,10 @@ static void run_actions (char **argv);
 static void usage (void);
 
 static void print_stats (void);
+#ifdef VM
+static void parse_evict_policy (const char *value);
+static void parse_swap_disks (char *value);
+#endif
 
 
 int main (void) NO_RETURN;
@@ -226,6 +231,20 @@ parse_options (char **argv) {
 			user_page_limit = atoi (value);
 		else if (!strcmp (name, "-threads-tests"))
 			thread_tests = true;
+#endif
+#ifdef VM
+		else if (!strcmp (name, "-evict"))
+			parse_evict_policy (value);
+		else if (!strcmp (name, "-swap"))
+			parse_swap_disks (value);
+		else if (!strcmp (name, "-swap-ra"))
+			swap_readahead = atoi (value);
+		else if (!strcmp (name, "-zswap"))
+			zswap_max_pages = atoi (value);
+		else if (!strcmp (name, "-large-pages"))
+			vm_large_pages = true;
+		else if (!strcmp (name, "-fault-around"))
+			vm_fault_around_pages = atoi (value) > 0 ? atoi (value) : 1;
 #endif
 		else
 			PANIC ("unknown option `%s' (use -h for help)", name);
@@ -234,6 +253,51 @@ parse_options (char **argv) {
 	return argv;
 }
 
+#ifdef VM
+/* -evict=fifo|clock: 프레임이 부족할 때 사용할 page replacement 정책 */
+static void
+parse_evict_policy (const char *value) {
+	if (value != NULL && !strcmp (value, "fifo"))
+		vm_evict_policy = VM_EVICT_FIFO;
+	else if (value != NULL && !strcmp (value, "clock"))
+		vm_evict_policy = VM_EVICT_CLOCK;
+	else
+		PANIC ("unknown eviction policy `%s' (use fifo or clock)", value);
+}
+
+/* -swap=CHAN:DEV[:PRIO][,CHAN:DEV[:PRIO]...]: hdCHAN:DEV 디스크들을 스왑 디스크로 쓴다.
+ * PRIO (기본 0)가 큰 디스크부터 쓰고, 같은 PRIO의 디스크들에는 슬롯을 번갈아 배치한다.
+ * 부팅 디스크 (hd0:0), 파일 시스템 디스크 (hd0:1), put/get에 쓰는 scratch 디스크 (hd1:0)와
+ * 같은 디스크를 두 번 적은 경우는 거부한다 */
+static void
+parse_swap_disks (char *value) {
+	char *disk, *save_ptr;
+	bool used[2][2] = { { true, true }, { true, false } };
+
+	if (value == NULL)
+		PANIC ("-swap needs CHAN:DEV[:PRIO] list");
+	for (disk = strtok_r (value, ",", &save_ptr); disk != NULL;
+			disk = strtok_r (NULL, ",", &save_ptr)) {
+		char *field_ptr;
+		char *chan = strtok_r (disk, ":", &field_ptr);
+		char *dev = strtok_r (NULL, ":", &field_ptr);
+		char *prio = strtok_r (NULL, ":", &field_ptr);
+
+		if (chan == NULL || dev == NULL || atoi (chan) < 0
+				|| (atoi (dev) != 0 && atoi (dev) != 1))
+			PANIC ("bad swap disk `%s' (use CHAN:DEV[:PRIO])", disk);
+		if (atoi (chan) < 2) {
+			if (used[atoi (chan)][atoi (dev)])
+				PANIC ("hd%d:%d cannot be a swap disk (boot, file system, scratch or listed twice)",
+						atoi (chan), atoi (dev));
+			used[atoi (chan)][atoi (dev)] = true;
+		}
+		if (!swap_config_disk (atoi (chan), atoi (dev), prio ? atoi (prio) : 0))
+			PANIC ("too many swap disks");
+	}
+}
+#endif
+
 /* Runs the task specified in ARGV[1]. */
 static void
 run_task (char **argv) {
@@ -328,6 +392,14 @@ usage (void) {
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -evict=POLICY      Page replacement POLICY: clock (default) or fifo.\n"
+			"  -swap=C:D[:P],...  Swap to disks hdC:D with priority P (default hd1:1).\n"
+			"  -swap-ra=PAGES     Read up to PAGES extra swap slots per swap-in (default 8).\n"
+			"  -zswap=PAGES       Keep up to PAGES of compressed swap in memory (0 disables).\n"
+			"  -large-pages       Map aligned 2 MB user regions with large pages.\n"
+			"  -fault-around=PAGES Load up to PAGES file pages per fault (default 1).\n"
 #endif
 			);
 	power_off ();
@@ -362,4 +434,7 @@ print_stats (void) {
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
+#ifdef VM
+	vm_print_stats ();
+#endif
 }
@@ -13,6 +13,7 @@
 #include "intrinsic.h"
 #ifdef USERPROG
 #include "userprog/gdt.h"
+#include "userprog/process.h"
 #endif
 
 /* Number of x86_64 interrupts. */
@@ -371,6 +372,14 @@ intr_handler (struct intr_frame *frame) {
 
 		if (yield_on_return)
 			thread_yield ();
+
+#ifdef USERPROG
+		/* A process chosen by the OOM killer while it was running
+		   (or ready to run) in user mode would otherwise keep its
+		   memory until its next fault or system call. */
+		if ((frame->cs & 3) == 3)
+			process_check_killed ();
+#endif
 	}
 }
 
@@ -13,6 +13,9 @@ pgdir_walk (uint64_t *pdp, const uint64_t va, int create) {
 	int idx = PDX (va);
 	if (pdp) {
 		uint64_t *pte = (uint64_t *) pdp[idx];
+		// 2MB 페이지는 PDE 자체가 마지막 단계의 엔트리
+		if (((uint64_t) pte & PTE_P) && ((uint64_t) pte & PTE_PS))
+			return &pdp[idx];
 		if (!((uint64_t) pte & PTE_P)) {
 			if (create) {
 				uint64_t *new_page = palloc_get_page (PAL_ZERO);
@@ -58,7 +61,8 @@ pdpe_walk (uint64_t *pdpe, const uint64_t va, int create) {
 /* 페이지 맵 레벨 4(pml4) 내에서 가상 주소 VADDR에 대한 페이지 테이블 엔트리의 주소를 반환합니다.
  * PML4E가 VADDR에 대한 페이지 테이블을 가지고 있지 않은 경우, 동작은 CREATE에 따라 달라집니다.
  * CREATE가 true인 경우, 새 페이지 테이블이 생성되고 해당 테이블 내의 포인터가 반환됩니다.
- * 그렇지 않으면 null 포인터가 반환됩니다. */
+ * 그렇지 않으면 null 포인터가 반환됩니다.
+ * VADDR이 2MB 페이지에 속하면 PDE의 주소를 반환한다 (A/D/W 비트 위치는 PTE와 같음). */
 uint64_t *
 pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	uint64_t *pte = NULL;
@@ -86,6 +90,59 @@ pml4e_walk (uint64_t *pml4e, const uint64_t va, int create) {
 	return pte;
 }
 
+/* TABLE[IDX]가 가리키는 다음 단계 테이블을 반환한다. 없으면 CREATE에 따라 새로 만든다 */
+static uint64_t *
+next_table (uint64_t *table, int idx, int create) {
+	if (!(table[idx] & PTE_P)) {
+		if (!create)
+			return NULL;
+		uint64_t *new_page = palloc_get_page (PAL_ZERO);
+		if (!new_page)
+			return NULL;
+		table[idx] = vtop (new_page) | PTE_U | PTE_W | PTE_P;
+	}
+	return ptov (PTE_ADDR (table[idx]));
+}
+
+/* VADDR을 덮는 PDE의 주소를 반환한다. 중간 단계 테이블이 없으면 CREATE에 따라 만든다.
+ * 2MB 페이지를 설치하거나 쪼갤 때 사용 */
+static uint64_t *
+pde_walk (uint64_t *pml4, const uint64_t va, int create) {
+	uint64_t *pdp = next_table (pml4, PML4 (va), create);
+	uint64_t *pd = pdp ? next_table (pdp, PDPE (va), create) : NULL;
+	return pd ? &pd[PDX (va)] : NULL;
+}
+
+/* 2MB 페이지 매핑 *PDE를 같은 물리 메모리를 가리키는 4kB PTE 512개짜리 페이지 테이블로 바꾼다.
+ * 권한과 accessed/dirty 비트는 모든 PTE에 그대로 복사된다. 메모리 부족 시 false */
+static bool
+large_page_split (uint64_t *pml4, uint64_t *pde) {
+	uint64_t *pt = palloc_get_page (0);
+	if (!pt)
+		return false;
+
+	uint64_t flags = *pde & (PTE_P | PTE_W | PTE_U | PTE_A | PTE_D);
+	uint64_t base = PTE_ADDR (*pde);
+	for (unsigned i = 0; i < LARGE_PGCNT; i++)
+		pt[i] = (base + i * PGSIZE) | flags;
+	*pde = vtop (pt) | PTE_U | PTE_W | PTE_P;
+
+	// 2MB TLB 엔트리를 확실히 버리기 위해 TLB 전체를 비운다
+	if (rcr3 () == vtop (pml4))
+		lcr3 (rcr3 ());
+	return true;
+}
+
+/* pml4e_walk와 같지만 VA가 2MB 페이지에 속하면 먼저 4kB 페이지들로 쪼갠다.
+ * 한 페이지만 바꾸는 연산 (매핑 변경, 해제, 권한/dirty 변경) 에서 사용 */
+static uint64_t *
+pml4e_walk_split (uint64_t *pml4, const uint64_t va, int create) {
+	uint64_t *pde = pde_walk (pml4, va, false);
+	if (pde && (*pde & PTE_P) && (*pde & PTE_PS) && !large_page_split (pml4, pde))
+		return NULL;
+	return pml4e_walk (pml4, va, create);
+}
+
 /* 새로운 pml4를 생성하고 커널 가상 주소에 대한 매핑을 가지지만
  * 사용자 가상 주소에 대한 매핑을 가지지 않는다.
  * 메모리 할당에 실패하면 새로운 페이지 디렉터리를 반환하거나 null 포인터를 반환한다. */
@@ -119,7 +176,7 @@ pgdir_for_each (uint64_t *pdp, pte_for_each_func *func, void *aux,
 		unsigned pml4_index, unsigned pdp_index) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		if (((uint64_t) pte) & PTE_P && !(((uint64_t) pte) & PTE_PS))
 			if (!pt_for_each ((uint64_t *) PTE_ADDR (pte), func, aux,
 					pml4_index, pdp_index, i))
 				return false;
@@ -166,7 +223,8 @@ static void
 pgdir_destroy (uint64_t *pdp) {
 	for (unsigned i = 0; i < PGSIZE / sizeof(uint64_t *); i++) {
 		uint64_t *pte = ptov((uint64_t *) pdp[i]);
-		if (((uint64_t) pte) & PTE_P)
+		// 2MB 페이지의 프레임은 VM이 관리하므로 여기서 해제하지 않는다
+		if (((uint64_t) pte) & PTE_P && !(((uint64_t) pte) & PTE_PS))
 			pt_destroy (PTE_ADDR (pte));
 	}
 	palloc_free_page ((void *) pdp);
@@ -213,8 +271,11 @@ pml4_get_page (uint64_t *pml4, const void *uaddr) {
 
 	uint64_t *pte = pml4e_walk (pml4, (uint64_t) uaddr, 0);
 
-	if (pte && (*pte & PTE_P))
+	if (pte && (*pte & PTE_P)) {
+		if (is_large_pte (pte))
+			return ptov (PTE_ADDR (*pte)) + large_pg_ofs (uaddr);
 		return ptov (PTE_ADDR (*pte)) + pg_ofs (uaddr);
+	}
 	return NULL;
 }
 
@@ -233,13 +294,54 @@ pml4_set_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
 	ASSERT (is_user_vaddr (upage));
 	ASSERT (pml4 != base_pml4);
 
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, 1);
+	uint64_t *pte = pml4e_walk_split (pml4, (uint64_t) upage, 1);
 
 	if (pte)
 		*pte = vtop (kpage) | PTE_P | (rw ? PTE_W : 0) | PTE_U;
 	return pte != NULL;
 }
 
+/* Adds a 2 MB mapping in PML4 from user virtual address UPAGE to
+ * the physically contiguous frames starting at kernel virtual
+ * address KPAGE.  Both must be aligned to LARGE_PGSIZE, and no
+ * 4 kB page in the range may be mapped.  An empty page table left
+ * over from earlier mappings is freed.  Any later change to a
+ * single 4 kB page in the range splits the mapping back into a
+ * page table.  Returns true if successful, false if memory
+ * allocation failed or part of the range is still mapped. */
+bool
+pml4_set_large_page (uint64_t *pml4, void *upage, void *kpage, bool rw) {
+	ASSERT (large_pg_ofs (upage) == 0);
+	ASSERT (large_pg_ofs (kpage) == 0);
+	ASSERT (is_user_vaddr (upage));
+	ASSERT (pml4 != base_pml4);
+
+	uint64_t *pde = pde_walk (pml4, (uint64_t) upage, 1);
+	if (!pde)
+		return false;
+
+	if (*pde & PTE_P) {
+		if (*pde & PTE_PS)
+			return false;
+		uint64_t *pt = ptov (PTE_ADDR (*pde));
+		for (unsigned i = 0; i < LARGE_PGCNT; i++)
+			if (pt[i] & PTE_P)
+				return false;
+		*pde = 0;
+		palloc_free_page (pt);
+	}
+	*pde = vtop (kpage) | PTE_P | PTE_PS | (rw ? PTE_W : 0) | PTE_U;
+	return true;
+}
+
+/* Returns true if user virtual address UPAGE is mapped in PML4
+ * by a 2 MB page. */
+bool
+pml4_is_large_page (uint64_t *pml4, const void *upage) {
+	uint64_t *pte = pml4e_walk (pml4, (uint64_t) upage, false);
+	return pte != NULL && (*pte & PTE_P) && is_large_pte (pte);
+}
+
 /* Marks user virtual page UPAGE "not present" in page
  * directory PD.  Later accesses to the page will fault.  Other
  * bits in the page table entry are preserved.
@@ -250,7 +352,7 @@ pml4_clear_page (uint64_t *pml4, void *upage) {
 	ASSERT (pg_ofs (upage) == 0);
 	ASSERT (is_user_vaddr (upage));
 
-	pte = pml4e_walk (pml4, (uint64_t) upage, false);
+	pte = pml4e_walk_split (pml4, (uint64_t) upage, false);
 
 	if (pte != NULL && (*pte & PTE_P) != 0) {
 		*pte &= ~PTE_P;
@@ -270,10 +372,12 @@ pml4_is_dirty (uint64_t *pml4, const void *vpage) {
 }
 
 /* Set the dirty bit to DIRTY in the PTE for virtual page VPAGE
- * in PML4. */
+ * in PML4.  Clearing the bit inside a 2 MB page splits it first so
+ * that the other pages keep their dirty state. */
 void
 pml4_set_dirty (uint64_t *pml4, const void *vpage, bool dirty) {
-	uint64_t *pte = pml4e_walk (pml4, (uint64_t) vpage, false);
+	uint64_t *pte = dirty ? pml4e_walk (pml4, (uint64_t) vpage, false)
+		: pml4e_walk_split (pml4, (uint64_t) vpage, false);
 	if (pte) {
 		if (dirty)
 			*pte |= PTE_D;
@@ -310,3 +414,20 @@ pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
 			invlpg ((uint64_t) vpage);
 	}
 }
+
+/* Sets the writable bit to WRITABLE in the PTE for virtual page
+ * VPAGE in PML4.  Other bits, including the dirty and accessed
+ * bits, are preserved. */
+void
+pml4_set_writable (uint64_t *pml4, const void *vpage, bool writable) {
+	uint64_t *pte = pml4e_walk_split (pml4, (uint64_t) vpage, false);
+	if (pte) {
+		if (writable)
+			*pte |= PTE_W;
+		else
+			*pte &= ~(uint64_t) PTE_W;
+
+		if (rcr3 () == vtop (pml4))
+			invlpg ((uint64_t) vpage);
+	}
+}
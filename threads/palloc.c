@@ -1,5 +1,6 @@
 #include "threads/palloc.h"
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -31,6 +32,7 @@ struct pool {
     struct lock lock;        /* Mutual exclusion. */
     struct bitmap *used_map; /* Bitmap of free pages. */
     uint8_t *base;           /* Base of pool. */
+    size_t free_cnt;         /* Number of free pages. */
 };
 
 /* Two pools: one for kernel data, one for user pages. */
@@ -41,6 +43,7 @@ size_t user_page_limit = SIZE_MAX;
 static void init_pool(struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool(const struct pool *, void *page);
+static void adjust_free_cnt(struct pool *, size_t page_cnt, bool freed);
 
 /* multiboot info */
 struct multiboot_info {
@@ -241,6 +244,8 @@ uint64_t palloc_init(void) {
     printf("\tbase_mem: 0x%llx ~ 0x%llx (Usable: %'llu kB)\n", base_mem.start, base_mem.end, base_mem.size / 1024);
     printf("\text_mem: 0x%llx ~ 0x%llx (Usable: %'llu kB)\n", ext_mem.start, ext_mem.end, ext_mem.size / 1024);
     populate_pools(&base_mem, &ext_mem);
+    kernel_pool.free_cnt = bitmap_count(kernel_pool.used_map, 0, bitmap_size(kernel_pool.used_map), false);
+    user_pool.free_cnt = bitmap_count(user_pool.used_map, 0, bitmap_size(user_pool.used_map), false);
     return ext_mem.end;
 }
 
@@ -258,9 +263,10 @@ void *palloc_get_multiple(enum palloc_flags flags, size_t page_cnt) {
     lock_release(&pool->lock);
     void *pages;
 
-    if (page_idx != BITMAP_ERROR)
+    if (page_idx != BITMAP_ERROR) {
         pages = pool->base + PGSIZE * page_idx;
-    else
+        adjust_free_cnt(pool, page_cnt, false);
+    } else
         pages = NULL;
 
     if (pages) {
@@ -283,6 +289,43 @@ void *palloc_get_multiple(enum palloc_flags flags, size_t page_cnt) {
    FLAGS, in which case the kernel panics. */
 void *palloc_get_page(enum palloc_flags flags) { return palloc_get_multiple(flags, 1); }
 
+/* Like palloc_get_multiple(), but the first page returned is
+   aligned to ALIGN_CNT pages, e.g. LARGE_PGCNT for the frames of
+   a 2 MB page.  Kernel virtual addresses map physical memory at
+   an aligned offset, so the physical address is aligned too. */
+void *palloc_get_aligned(enum palloc_flags flags, size_t page_cnt, size_t align_cnt) {
+    struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+    size_t align = align_cnt * PGSIZE;
+    size_t first = (ROUND_UP((uintptr_t)pool->base, align) - (uintptr_t)pool->base) / PGSIZE;
+    size_t page_idx = BITMAP_ERROR;
+
+    lock_acquire(&pool->lock);
+    for (size_t idx = first; idx + page_cnt <= bitmap_size(pool->used_map); idx += align_cnt)
+        if (bitmap_none(pool->used_map, idx, page_cnt)) {
+            bitmap_set_multiple(pool->used_map, idx, page_cnt, true);
+            page_idx = idx;
+            break;
+        }
+    lock_release(&pool->lock);
+    void *pages;
+
+    if (page_idx != BITMAP_ERROR) {
+        pages = pool->base + PGSIZE * page_idx;
+        adjust_free_cnt(pool, page_cnt, false);
+    } else
+        pages = NULL;
+
+    if (pages) {
+        if (flags & PAL_ZERO)
+            memset(pages, 0, PGSIZE * page_cnt);
+    } else {
+        if (flags & PAL_ASSERT)
+            PANIC("palloc_get: out of pages");
+    }
+
+    return pages;
+}
+
 /* Frees the PAGE_CNT pages starting at PAGES. */
 void palloc_free_multiple(void *pages, size_t page_cnt) {
     struct pool *pool;
@@ -306,11 +349,30 @@ void palloc_free_multiple(void *pages, size_t page_cnt) {
 #endif
     ASSERT(bitmap_all(pool->used_map, page_idx, page_cnt));
     bitmap_set_multiple(pool->used_map, page_idx, page_cnt, false);
+    adjust_free_cnt(pool, page_cnt, true);
 }
 
 /* Frees the page at PAGE. */
 void palloc_free_page(void *page) { palloc_free_multiple(page, 1); }
 
+/* Returns the number of free pages in the user pool. */
+size_t palloc_user_free_cnt(void) { return user_pool.free_cnt; }
+
+/* Returns the number of pages in the user pool. */
+size_t palloc_user_page_cnt(void) { return bitmap_size(user_pool.used_map); }
+
+/* Updates POOL's free page count after PAGE_CNT pages were
+   allocated or FREED.  Frees may run with interrupts off and
+   without the pool lock, so the update is done atomically. */
+static void adjust_free_cnt(struct pool *pool, size_t page_cnt, bool freed) {
+    enum intr_level old_level = intr_disable();
+    if (freed)
+        pool->free_cnt += page_cnt;
+    else
+        pool->free_cnt -= page_cnt;
+    intr_set_level(old_level);
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void init_pool(struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
     /* We'll put the pool's used_map at its base.
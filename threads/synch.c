@@ -49,6 +49,32 @@ void sema_down(struct semaphore *sema) {
     intr_set_level(old_level);
 }
 
+/* sema_down과 같지만, 기다리는 도중 OOM killer가 현재 스레드를 희생자로 고르고 thread_interrupt()로 깨우면
+   세마포어를 내리지 않고 false를 반환하는 응용함수 (성공시 true). 종료될 스레드가 무한정 기다리지 않도록 할 때 사용. */
+bool sema_down_killable(struct semaphore *sema) {
+
+    ASSERT(sema != NULL);
+    ASSERT(!intr_context());
+
+    enum intr_level old_level = intr_disable();
+    struct thread *curr = thread_current();
+
+    while (sema->value == 0) {
+        if (curr->oom_killed) {
+            intr_set_level(old_level);
+            return false;
+        }
+        list_insert_ordered(&sema->waiters, &curr->elem, priority_comparison, NULL);
+        curr->killable_sema = sema; // thread_interrupt()가 waiters에서 빼낼 수 있도록 표시
+        thread_block();
+        curr->killable_sema = NULL;
+    }
+
+    sema->value--;
+    intr_set_level(old_level);
+    return true;
+}
+
 /* sema_down을 시도 ; 성공시 true, 실패한다면 false를 반환하는 응용함수.
    Interrupt Handler에서도 호출 가능 (thread_block() 없음). */
 bool sema_try_down(struct semaphore *sema) {
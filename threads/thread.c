@@ -29,6 +29,7 @@ static struct lock tid_lock;          // Allocate_tid()에서 사용되는 락
 static struct list ready_list;      // THREAD_READY로 대기중인 프로세스들을 위한 리스트 (Run 준비 완료 상태)
 static struct list sleep_list;      // Sleep 상태의 스레드들을 저장해두는 리스트 (우선순위가 높으면 앞에 배치)
 static struct list destruction_req; // 삭제할 스레드들을 임시 저장하는 리스트 (do_schedule에서 처리)
+static struct list all_list;        // 생성된 뒤 아직 종료하지 않은 모든 스레드의 리스트 (thread_foreach에서 순회)
 
 /* 시스템 통계 및 타이머에서 활용하는 Ticks */
 
@@ -80,6 +81,7 @@ void thread_init(void) {
     list_init(&ready_list);
     list_init(&sleep_list);
     list_init(&destruction_req);
+    list_init(&all_list);
     lock_init(&file_lock);
 
     /* 구동되기 시작한 Initial Thread의 Struct Thread 값을 설정 */
@@ -293,6 +295,7 @@ void thread_exit(void) {
 
     /* THREAD_DYING으로 지정하고 스케쥴러를 호출, do_schedule에서 삭제 대상들을 일괄 삭제 */
     intr_disable();
+    list_remove(&thread_current()->all_elem);
     do_schedule(THREAD_DYING);
     NOT_REACHED();
 }
@@ -324,6 +327,32 @@ void thread_check_yield(void) {
     }
 }
 
+/* sema_down_killable()로 잠들어 있는 스레드 T를 그 세마포어의 waiters에서 빼서 ready_list로 돌려보내는 함수.
+   깨어난 스레드는 종료 표시 (oom_killed)를 확인하고 세마포어를 내리지 않은 채 돌아간다.
+   다른 이유로 Block 된 스레드는 elem이 어느 리스트에 있는지 알 수 없으므로 건드리지 않음
+   (그런 스레드는 시스템 콜, 폴트, 인터럽트에서 유저로 돌아가는 시점에 종료 표시를 확인). */
+void thread_interrupt(struct thread *t) {
+
+    ASSERT(is_thread(t));
+    enum intr_level old_level = intr_disable();
+
+    if (t->status == THREAD_BLOCKED && t->killable_sema != NULL) {
+        list_remove(&t->elem);
+        t->killable_sema = NULL;
+        thread_unblock(t);
+    }
+    intr_set_level(old_level);
+}
+
+/* 살아있는 모든 스레드에 대해 FUNC(t, AUX)를 호출하는 함수. Interrupt를 끈 상태에서 호출해야 함. */
+void thread_foreach(thread_action_func *func, void *aux) {
+
+    ASSERT(intr_get_level() == INTR_OFF);
+
+    for (struct list_elem *e = list_begin(&all_list); e != list_end(&all_list); e = list_next(e))
+        func(list_entry(e, struct thread, all_elem), aux);
+}
+
 /* 현재 Run 중인 스레드의 우선순위를 변경하는 함수 */
 void thread_set_priority(int new_priority) {
 
@@ -451,6 +480,14 @@ static void init_thread(struct thread *t, const char *name, int priority) {
     t->exit_status = 0;          // 기본 값은 0 (exit 없이 성공적으로 탈출))
     t->already_waited = false; // 해당 자식이 아직 wait를 받은적이 없다는 의미
     t->fork_depth = 0;
+#ifdef VM
+    supplemental_page_table_init(&t->spt); // 유저 프로세스가 아닌 채로 종료하는 스레드도 spt 정리가 가능하도록
+#endif
+
+    /* thread_foreach로 순회할 수 있도록 all_list에 추가 */
+    enum intr_level old_level = intr_disable();
+    list_push_back(&all_list, &t->all_elem);
+    intr_set_level(old_level);
 }
 
 /* CPU를 할당받을 다음 스레드를 고르는 함수 (idle thread가 여기서 적용) */
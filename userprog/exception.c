@@ -117,6 +117,10 @@ static void page_fault(struct intr_frame *f) {
         // 유저레벨에 해당하는 rsp를 미리 저장해두어야 추후 syscall 에러를 처리하다가 fault가 났을 때 올바른 유저 스택값을 얻을 수 있음
         thread_current()->rsp_stack = f->rsp;
 
+    // OOM killer에게 희생자로 뽑힌 프로세스는 유저 폴트에서 종료한다 (커널 락을 잡고 있지 않은 지점)
+    if (user)
+        process_check_killed();
+
     if (vm_try_handle_fault(f, fault_addr, user, write, not_present))   // 페이지 폴트 처리
         return;
 #endif
@@ -2,10 +2,12 @@
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/inode.h"
 #include "intrinsic.h"
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
 #include "threads/synch.h" // fd_lock을 스레드마다 구현하기 위함
@@ -191,6 +193,7 @@ static void __do_fork(void *aux) {
     process_activate(current);
 #ifdef VM
     supplemental_page_table_init(&current->spt);
+    current->rss_limit = parent->rss_limit;
     if (!supplemental_page_table_copy(&current->spt, &parent->spt))
         goto error;
 #else
@@ -306,7 +309,17 @@ int process_wait(tid_t child_tid) {
 
     /* (3) 문제없이 찾았다면 child의 already_waited 태그를 업데이트하고, wait_sema 대기 시작. */
     child->already_waited = true;
+#ifdef VM
+    /* OOM killer가 기다리는 도중의 부모를 희생자로 고르면 자식을 기다리지 않고 바로 종료.
+       자식이 process_exit에서 free_sema를 무한정 기다리지 않도록 미리 풀어주고 호적에서도 제거 */
+    if (!sema_down_killable(&child->wait_sema)) {
+        list_remove(&child->child_elem);
+        sema_up(&child->free_sema);
+        exit(-1);
+    }
+#else
     sema_down(&child->wait_sema);
+#endif
 
     /* (4) Child가 process_exit에서 시그널을 보냈으니 sema_down(wait_sema)가 통과됨 ; 이제 해당 Child의 exit_status 저장. */
     int return_status = child->exit_status;
@@ -321,6 +334,18 @@ int process_wait(tid_t child_tid) {
     return return_status;
 }
 
+/* OOM killer가 현재 프로세스를 희생자로 골랐다면 exit(-1)로 종료하는 함수.
+   유저 모드로 돌아가기 직전 (시스템 콜, page fault, 인터럽트 처리의 끝)처럼 커널 락을 잡고 있지 않은 지점에서 호출.
+   외부 인터럽트 처리 끝에서는 Interrupt가 꺼진 채로 불리므로 종료하기 전에 다시 켠다. */
+void process_check_killed(void) {
+#ifdef VM
+    if (!thread_current()->oom_killed)
+        return;
+    intr_enable();
+    exit(-1);
+#endif
+}
+
 /* thread_exit에서 호출되는 함수로, 프로세스를 종료시킴. */
 void process_exit(void) {
 
@@ -348,7 +373,6 @@ void process_exit(void) {
     file_close(curr->running);
 
     process_cleanup();
-    hash_destroy(&curr->spt.hash_table, NULL);
 
     /* 부모의 wait() 대기 ; 부모가 wait을 해줘야 죽을 수 있음 (한계) */
     // if (curr->parent_is) {
@@ -787,32 +811,6 @@ static bool install_page(void *upage, void *kpage, bool writable) {
 /* From here, codes will be used after project 3.
  * If you want to implement the function for only project 2, implement it on the
  * upper block. */
-static bool lazy_load_segment(struct page *page, void *aux_) {
-    ASSERT(page->frame->kva != NULL);
-
-    struct lazy_load_aux *aux = (struct lazy_load_aux*) aux_;    // void로 전달됐으므로 구조체로 형변환
-
-    // 구조체로부터 페이징[ 로드되어야 하는 파일 데이터 크기와 나머지 부분을 0으로 설정해야 하는 크기 가져옴
-    size_t page_read_bytes = aux->read_bytes;   // 페이지에 로드되어야 하는 파일에서 읽어야 하는 바이트 수
-    size_t page_zero_bytes = aux->zero_bytes;   // 페이지의 나머지 부분을 0으로 설정해야 하는 바이트 수
-
-    // 로딩 실패
-    if (!page || !page->frame)
-        return false;
-
-    // 파일에서 데이터를 읽어서 페이지에 로드
-    // 읽기 도중 오류가 발생하거나 읽은 바이트 수가 page_read_bytes와 일치하지 않으면 로딩 실패
-    if (file_read_at(aux->file, page->frame->kva, page_read_bytes, aux->ofs) != (int)page_read_bytes) {
-        free(aux);
-        return false;
-    }
-
-    // 읽어온 데이터 이후의 나머지 바이트 0으로 설정하는 역할
-    // 페이지에 남은 부분은 0으로 초기화되어 메모리가 쓰레기 값으로 채워지지 않고 초기화된 페이지가 사용자 프로세스에 안전하게 전달된다.
-    memset(page->frame->kva + page_read_bytes, 0, page_zero_bytes);
-    
-    return true;
-}
 
 /* 파일에서 데이터를 읽어와 유저 가상 메모리에 로드하는 데 사용됨
 
@@ -829,32 +827,21 @@ static bool load_segment(struct file *file, off_t ofs, uint8_t *upage, uint32_t
     ASSERT(pg_ofs(upage) == 0); // upage가 페이지의 시작점
     ASSERT(ofs % PGSIZE == 0);  // ofs는 페이지 크기의 배수 -> 파일 오프셋을 페이지 정렬로 처리하는데 사용
 
-    // read bytes, zero bytes 처리하면서 페이지 초기화
-    while (read_bytes > 0 || zero_bytes > 0) {  // 모든 바이트가 처리될 때까지 페이지별로 계산 수행
-        size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
-        size_t page_zero_bytes = PGSIZE - page_read_bytes;
+    // 페이지마다 struct page와 aux를 만드는 대신 세그먼트 전체를 영역 하나로 기술한다.
+    // 각 페이지는 처음 폴트가 날 때 영역 정보로부터 만들어짐 (vm_area_materialize)
+    struct supplemental_page_table *spt = &thread_current()->spt;
+    struct vm_area *area;
 
-        // lazy loading 동안 해당 페이지에 대한 정보를 전달하기 위한 구조체 aux 할당 & 초기화
-        struct lazy_load_aux *aux = (struct lazy_load_aux*) malloc(sizeof(struct lazy_load_aux));
-
-        aux->file = file;
-        aux->ofs = ofs;
-        aux->read_bytes = page_read_bytes;
-        aux->zero_bytes = page_zero_bytes;
-        aux->writable = writable;
- 
-        // 페이지 할당. 이 함수는 VM_ANON 타입의 페이지를 생성하며, 페이지가 쓰기 가능한지 여부와 초기화
-        if (!vm_alloc_page_with_initializer(VM_ANON, upage, writable, lazy_load_segment, aux)) {
-            free(aux);
-            return false;
-        }
-
-        // 다음 페이지로 이동하기 위해 각 변수 업데이트하고 루프 반복
-        ofs += page_read_bytes;
-        read_bytes -= page_read_bytes;
-        zero_bytes -= page_zero_bytes;
-        upage += PGSIZE;
-    }
+    // read-only 코드 페이지는 같은 실행 파일을 돌리는 프로세스들끼리 프레임을 공유하고,
+    // 데이터 페이지는 처음 쓰기 전까지 실행 파일에서 다시 읽을 수 있으므로 스왑에 쓰지 않는다
+    enum vm_type type = VM_FILE | (writable ? VM_PRIVATE : VM_TEXT);
+    area = vm_area_create(spt, upage, read_bytes + zero_bytes, type, writable, lazy_load_text);
+    if (!area)
+        return false;
+    // 실행 파일은 exec 도중 닫힐 수 있으므로 영역이 inode 참조를 갖는다
+    area->inode = inode_reopen(file_get_inode(file));
+    area->ofs = ofs;
+    area->read_bytes = read_bytes;
     return true;    // 모든 페이지가 성공적으로 load되면 true 반환
 }
 
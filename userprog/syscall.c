@@ -39,6 +39,13 @@ unsigned tell(int fd);
 void close(int fd);
 void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
 void munmap(void *addr);
+int msync(void *addr, size_t length);
+size_t working_set(void);
+int madvise(void *addr, size_t length, int advice);
+int munmap_range(void *addr, size_t length);
+int mprotect(void *addr, size_t length, bool writable);
+void rss_limit(size_t pages);
+size_t resident_set(void);
 
 /* File Descriptor 관련 함수 Prototype & Global Variables */
 int allocate_fd(struct file *file);
@@ -91,6 +98,11 @@ void syscall_handler(struct intr_frame *f) {
 
     int syscall_num = f->R.rax;
 
+#ifdef VM
+    // OOM killer에게 희생자로 뽑힌 프로세스는 시스템 콜에 들어오는 지점에서 종료한다
+    process_check_killed();
+#endif
+
     switch (syscall_num) {
 
     case SYS_HALT:
@@ -156,10 +168,43 @@ void syscall_handler(struct intr_frame *f) {
         munmap(f->R.rdi);
         break;
 
+    case SYS_MSYNC:
+        f->R.rax = msync((void *) f->R.rdi, f->R.rsi);
+        break;
+
+    case SYS_WORKING_SET:
+        f->R.rax = working_set();
+        break;
+
+    case SYS_MADVISE:
+        f->R.rax = madvise((void *) f->R.rdi, f->R.rsi, f->R.rdx);
+        break;
+
+    case SYS_MUNMAP_RANGE:
+        f->R.rax = munmap_range((void *) f->R.rdi, f->R.rsi);
+        break;
+
+    case SYS_MPROTECT:
+        f->R.rax = mprotect((void *) f->R.rdi, f->R.rsi, f->R.rdx);
+        break;
+
+    case SYS_RSS_LIMIT:
+        rss_limit(f->R.rdi);
+        break;
+
+    case SYS_RESIDENT_SET:
+        f->R.rax = resident_set();
+        break;
+
     default:
         printf("Unknown system call: %d\n", syscall_num); // deprecated by placeholder, but kept in place
         thread_exit();
     }
+
+#ifdef VM
+    // 시스템 콜 도중 (락이나 디스크를 기다리다가) 희생자로 뽑혔다면 유저로 돌아가지 않고 종료한다
+    process_check_killed();
+#endif
     return;
 }
 
@@ -170,17 +215,19 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset) {
     if (offset % PGSIZE != 0)
         return false;
 
-    // 두번째 검증
-    if (!addr || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
+    // 두번째 검증: addr이 NULL이면 MAP_ANYWHERE로 커널에게 자리를 맡긴 경우만 허용
+    bool anywhere = !addr && (writable & MAP_ANYWHERE);
+    if ((!addr && !anywhere) || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
         return false;
 
     // 세번째 검증
     if ((long)length <= 0)
         return false;
 
-    // 네번째 검증
+    // 네번째 검증: 매핑할 범위 전체가 기존 페이지나 영역(ELF 세그먼트, 다른 mmap)과 겹치지 않아야 함
     struct thread *curr = thread_current();
-    if (spt_find_page(&curr->spt, addr))
+    if (!anywhere && (spt_find_range(&curr->spt, addr, addr + length)
+                      || vm_area_overlaps(&curr->spt, addr, addr + length)))
         return false;
 
     // 마지막 검증
@@ -198,6 +245,67 @@ void munmap(void *addr) {
     do_munmap(addr);
 }
 
+/* [addr, addr + length)의 dirty mmap 페이지를 즉시 파일에 기록한다.
+ * addr은 페이지 정렬된 유저 주소여야 하며, 실패 시 -1 반환 */
+int msync(void *addr, size_t length) {
+    if (!addr || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
+        return -1;
+    if (length == 0 || is_kernel_vaddr(addr + length - 1) || addr + length < addr)
+        return -1;
+
+    return do_msync(addr, length);
+}
+
+/* 최근 몇 번의 샘플 구간 동안 이 프로세스가 실제로 접근한 페이지 수의 감쇠 평균 */
+size_t working_set(void) {
+    return vm_working_set();
+}
+
+/* munmap과 달리 [addr, addr + length)에 걸친 mmap 영역의 해당 부분만 해제한다.
+ * addr은 페이지 정렬된 유저 주소여야 하며, 실패 시 -1 반환 */
+int munmap_range(void *addr, size_t length) {
+    if (!addr || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
+        return -1;
+    if (length == 0 || is_kernel_vaddr(addr + length - 1) || addr + length < addr)
+        return -1;
+
+    return do_munmap_range(addr, length);
+}
+
+/* [addr, addr + length)의 쓰기 권한을 바꾼다.
+ * addr은 페이지 정렬된 유저 주소여야 하며, 실패 시 -1 반환 */
+int mprotect(void *addr, size_t length, bool writable) {
+    if (!addr || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
+        return -1;
+    if (length == 0 || is_kernel_vaddr(addr + length - 1) || addr + length < addr)
+        return -1;
+
+    return vm_mprotect(addr, length, writable);
+}
+
+/* 이 프로세스가 프레임을 최대 pages개만 쓰게 한다 (0이면 제한 없음).
+ * 한도에 닿으면 다른 프로세스 대신 자기 페이지를 내보낸다.
+ * fork한 자식에게 물려주고 exec 후에도 유지되므로, fork 후 exec 전에 정해 두면 된다 */
+void rss_limit(size_t pages) {
+    thread_current()->rss_limit = pages;
+}
+
+/* 이 프로세스의 페이지가 매핑된 프레임 수 */
+size_t resident_set(void) {
+    return thread_current()->rss;
+}
+
+/* [addr, addr + length)를 어떻게 쓸지 VM에 알려준다 (MADV_*).
+ * addr은 페이지 정렬된 유저 주소여야 하며, 실패 시 -1 반환 */
+int madvise(void *addr, size_t length, int advice) {
+    if (!addr || pg_round_down(addr) != addr || is_kernel_vaddr(addr))
+        return -1;
+    if (length == 0 || is_kernel_vaddr(addr + length - 1) || addr + length < addr)
+        return -1;
+
+    return vm_madvise(addr, length, advice);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////// Pointer Validity Checks /////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -429,6 +537,33 @@ int filesize(int fd) {
     return file_length(file);
 }
 
+/* 한 번에 메모리에 고정하는 유저 버퍼 크기. 큰 버퍼 하나가 유저 프레임을 모두 고정하지 않도록 나눠서 처리 */
+#define IO_PIN_CHUNK (64 * PGSIZE)
+
+/* FILE과 유저 BUFFER 사이에서 SIZE 바이트를 읽거나 (IS_WRITE가 false) 쓴다.
+   버퍼를 IO_PIN_CHUNK씩 메모리에 올려 고정한 다음에 file lock을 잡으므로,
+   다른 프로세스가 파일 I/O를 하는 동안 이 프로세스의 page fault가 file lock 뒤에서 기다리지 않고
+   버퍼 프레임이 I/O 도중에 쫓겨나지도 않는다. 실제로 처리한 바이트 수를 반환 */
+static int file_io_pinned(struct file *file, void *buffer, unsigned size, bool is_write) {
+    unsigned done = 0;
+
+    while (done < size) {
+        unsigned chunk = size - done < IO_PIN_CHUNK ? size - done : IO_PIN_CHUNK;
+
+        if (!vm_pin_buffer(buffer + done, chunk, !is_write))
+            exit(-1);
+        file_lock_acquire();
+        int n = is_write ? file_write(file, buffer + done, chunk) : file_read(file, buffer + done, chunk);
+        file_lock_release();
+        vm_unpin_buffer(buffer + done, chunk);
+
+        done += n;
+        if ((unsigned)n < chunk)
+            break;
+    }
+    return done;
+}
+
 /* 'size' 바이트 만큼 열린 파일 fd에서 read를 실행, buffer에 저장하는 함수.
    함수 리턴값은 실제로 읽기에 성공한 바이트 수, 또는 실패시 -1.
    fd 0은 input_getc()를 통해서 키보드 입력값을 읽어옴. */
@@ -438,10 +573,9 @@ int read(int fd, void *buffer, unsigned size) {
         exit(-1);
 
     // buffer는 코드 영역이라 쓰기 불가능하므로 예외 처리 해줘야 함
-    uint64_t *pte = pml4e_walk(thread_current()->pml4, buffer, 0);
     // read only에서 write 요청한 경우 exit(-1)
-    
-    if (*pte && !is_writable(pte))
+    // fork 후 COW로 공유 중인 페이지는 커널이 쓰기 전에 미리 복사해둠
+    if (!vm_prepare_write(buffer, size))
         exit(-1);
 
     /* 읽어온 바이트 수를 기록할 변수 초기화 */
@@ -475,15 +609,8 @@ int read(int fd, void *buffer, unsigned size) {
             file_lock_release();
             return -1; // exit(-1)을 하려다가, 공식 문서에 적힌대로 우선 -1로 바꾼 상태
         }
-        // 커널 풀에서 writable이 0이라도 read write 가 일어나므로, 오로지 read 만 일어날 수 있게 하기 위해 처리
-        struct page *page = spt_find_page(&thread_current()->spt,buffer);
-        if(page && !page->writable){
-            file_lock_release();
-            exit(-1);
-        }
-
-        read_count = file_read(file, buffer, size); // file_read는 size를 (off_t*) 형태로 바라는 것 같은데, 에러가 떠서 일단 일반 사이즈로 넣음
         file_lock_release();
+        read_count = file_io_pinned(file, buffer, size, false);
     }
     // read_count = file_read(file, buffer, size); // file_read는 size를 (off_t*) 형태로 바라는 것 같은데, 에러가 떠서 일단 일반 사이즈로 넣음
     return read_count;
@@ -518,10 +645,8 @@ int write(int fd, const void *buffer, unsigned size) {
         return NULL;
     } // 만일 deny_write라면 실패 반환 (임시, sync_write 등에서 수정 필요할 가능성 높음)
 
-    file_lock_acquire();
-    int bytes_written = file_write(file_to_write, buffer, size);
+    int bytes_written = file_io_pinned(file_to_write, (void *)buffer, size, true);
 
-    file_lock_release();
     // sema_up(&filesys_sema);
 
     return bytes_written;
@@ -4,12 +4,10 @@
 #include "devices/disk.h"
 #include "threads/vaddr.h"
 #include "threads/mmu.h"
-#include "bitmap.h"
+#include "vm/swap.h"
 
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
-struct bitmap *swap_bitmap;	// 스왑 테이블 (할당받은 스왑 디스크를 관리하는 테이블)
-const size_t SECTORS_PER_PAGE = PGSIZE / DISK_SECTOR_SIZE;	// 한 페이지가 차지하는 섹터 수 = 8
 static bool anon_swap_in (struct page *page, void *kva);
 static bool anon_swap_out (struct page *page);
 static void anon_destroy (struct page *page);
@@ -25,20 +23,12 @@ static const struct page_operations anon_ops = {
 
 /* Initialize the data for anonymous pages
  * 1. 스왑 디스크 설정
- * 2. 사용 가능한 영역과 사용된 영역을 관리하기 위한 데이터 struct 설정
- * 3. 스왑 영역 PGSIZE 단위로 관리 */
+ * 2. 스왑 영역을 페이지 크기 슬롯 단위로 관리하는 swap.c 초기화
+ *    -swap 옵션으로 스왑 디스크들을 정하지 않았으면 hd1:1 하나를 쓴다 */
 void
 vm_anon_init (void) {
-	swap_disk = disk_get(1, 1);		// 스왑 디스크 설정
-
-	// 스왑 디스크에서 사용 가능한 영역과 사용된 영역을 관리하기 위해서는 bitmap 사용
-	// 스왑 디스크의 각 섹터(페이지)에 대해 비트맵 상에서 해당 섹터의 사용 여부를 추적할 수 있다.
-	// 비트맵은 각 섹터가 사용 중인지 여부를 나타내는 플래그로 구성된다.
-	// 스왑 디스크 크기(디스크에 들어갈 수 있는 page 개수)
-	size_t swap_size = disk_size(swap_disk);
-
-	// 스왑 디스크 크기에 맞는 비트맵 초기화
-	swap_bitmap = bitmap_create(swap_size);
+	swap_disk = disk_get(1, 1);		// 기본 스왑 디스크
+	swap_init(swap_disk);
 }
 
 /* Initialize the file mapping
@@ -49,62 +39,157 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 	page->operations = &anon_ops;
 
 	struct anon_page *anon_page = &page->anon;
+	anon_page->slot = SWAP_SLOT_NONE;	// 아직 스왑 슬롯 없음
 	return true;
 }
 
+/* PAGE의 스왑 슬롯을 SLOT으로 바꾸고 주인 프로세스의 스왑 사용량(swap_pages)을 맞춘다.
+ * OOM killer가 희생자를 고를 때 이 값을 본다 */
+static void
+anon_set_slot (struct page *page, swap_slot_t slot) {
+	struct anon_page *anon_page = &page->anon;
+
+	if (anon_page->slot != SWAP_SLOT_NONE)
+		page->owner->swap_pages--;
+	if (slot != SWAP_SLOT_NONE)
+		page->owner->swap_pages++;
+	anon_page->slot = slot;
+}
+
+/* PAGE가 붙들고 있는 스왑 슬롯이 있으면 반환한다 */
+void
+anon_release_slot (struct page *page) {
+	if (page->anon.slot == SWAP_SLOT_NONE)
+		return;
+	swap_slot_free (page->anon.slot);
+	anon_set_slot (page, SWAP_SLOT_NONE);
+}
+
+/* fork: 쫓겨나 있는 부모 페이지 SRC의 스왑 슬롯을 자식 페이지 DST가 함께 가리키게 한다.
+ * 내용을 메모리에 올려 복사하지 않고 슬롯 참조 수만 늘린다. 슬롯의 내용은 모든 참조가
+ * 사라질 때까지 바뀌지 않고, 먼저 써서 다시 쫓겨나는 쪽이 새 슬롯을 받는다 */
+void
+anon_share_slot (struct page *dst, struct page *src) {
+	ASSERT (src->anon.slot != SWAP_SLOT_NONE);
+
+	swap_slot_dup (src->anon.slot);
+	anon_set_slot (dst, src->anon.slot);
+}
+
 /* Swap in the page by read contents from the swap disk.
- * 스왑 디스크 데이터 내용을 읽어서 익명 페이지를 디스크에서 메모리로 swap in */
+ * 스왑 디스크 데이터 내용을 읽어서 익명 페이지를 디스크에서 메모리로 swap in.
+ * 슬롯은 바로 반환하지 않고 붙들고 있다가 (스왑 캐시), 페이지에 쓰지 않은 채로 다시
+ * 쫓겨나면 디스크에 쓰지 않고 그 슬롯을 그대로 쓴다. */
 static bool
 anon_swap_in (struct page *page, void *kva) {
 	struct anon_page *anon_page = &page->anon;
 
-	disk_sector_t sector = anon_page->start_sector_num;
+	// 슬롯 한 개(8섹터)를 디스크 명령 하나로 읽는다
+	// 압축 풀에서만 갖고 있던 내용이면 슬롯에 남는 게 없으므로 반환
+	if (!swap_read(anon_page->slot, kva))
+		anon_release_slot(page);
+	return true;
+}
+
+/* PAGE와 같은 프로세스에서 바로 앞(뒤) 가상 페이지가 스왑 아웃된 anon 페이지면
+ * 그 슬롯의 다음(이전) 슬롯을 반환한다. 없으면 SWAP_SLOT_NONE */
+static swap_slot_t
+neighbor_slot_hint (struct page *page) {
+	struct supplemental_page_table *spt = &page->owner->spt;
+	struct page *prev = spt_find_page(spt, page->va - PGSIZE);
+	struct page *next = spt_find_page(spt, page->va + PGSIZE);
+
+	if (prev && VM_TYPE(prev->operations->type) == VM_ANON
+			&& prev->anon.slot != SWAP_SLOT_NONE)
+		return prev->anon.slot + 1;
+	if (next && VM_TYPE(next->operations->type) == VM_ANON
+			&& next->anon.slot != SWAP_SLOT_NONE && next->anon.slot > 0)
+		return next->anon.slot - 1;
+	return SWAP_SLOT_NONE;
+}
 
-	for (int i=0; i<SECTORS_PER_PAGE; i++)
-		disk_read(swap_disk, sector + i, kva + (i * DISK_SECTOR_SIZE));
-	
-	bitmap_set_multiple(swap_bitmap, sector, 8, false);
-	pml4_set_page(thread_current()->pml4, page->va, kva, page->writable);
-	anon_page->start_sector_num = NULL;
+/* 쫓겨나는 PAGE의 매핑과 프레임 연결을 끊는다 -> 페이지 스왑 완료.
+ * 다른 프로세스의 페이지를 쫓아낼 수도 있으므로 thread_current()가 아닌 owner의 pml4 사용 */
+static void
+anon_unmap (struct page *page) {
+	pml4_clear_page(page->owner->pml4, page->va);
+	page->frame->page = NULL;
+	page->frame = NULL;
 }
 
 /* Swap out the page by writing contents to the swap disk.
  * 메모리에서 디스크로 내용을 복사하여 익명 페이지를 스왑 디스크로 교체한다.
- * 스왑 테이블을 사용하여 디스크에서 사용 가능한 스왑 슬롯을 찾은 다음 데이터 페이지를 슬롯에 복사한다.
- * 데이터의 위치는 스왑 디스크에 있다.
- * 데이터 위치 -> 페이지 구조체에 저장 -> 스왑 디스크에 저장 = 스왑 테이블 업데이트
- * 데이터의 위치는 페이지 구조체에 저장되어야 한다. 디스크에 사용 가능한 슬롯이 더 이상 없으면 커널 패닉 발생 가능
- * 디스크로 옮겨주는 작업만 해주면 됨 */
+ * 빈 스왑 슬롯을 하나 받아 페이지 전체를 한 번의 디스크 명령으로 쓰고,
+ * 슬롯 번호를 페이지 구조체에 저장한다. 빈 슬롯이 없으면 false 반환. */
 static bool   
 anon_swap_out (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
-	
-	// 비트맵을 순회하며 0인 비트를 찾는다. 연속된 8개의 비트 찾아서 1로 변경
-	// 찾은 스왑 슬롯의 첫번째 섹터 번호 저장
-	disk_sector_t start_sector = bitmap_scan_and_flip(swap_bitmap, 0, 8, false);
-	
-	if (start_sector == BITMAP_ERROR)
-		return false;
-
-	// 페이지의 anon 구조체 내부에 스왑 슬롯의 시작 섹터 번호 저장
-	anon_page->start_sector_num = start_sector;
+	struct anon_swap_batch batch;
 
-	// for문 돌려서 8섹터 한번에 write 할 수 있게 해야함
-	// 페이지가 8개의 디스크 섹터에 걸쳐 저장될 것 이므로 8번 반복 수행
-	for (int i=0; i<SECTORS_PER_PAGE; i++)
-		disk_write(swap_disk, start_sector + i, page->frame->kva + (i * DISK_SECTOR_SIZE));
+	if (anon_swap_out_begin (&page, 1, &batch) == 0)
+		return false;
+	swap_write_batch (batch.slots, batch.kvas, batch.cnt);
+	anon_swap_out_end (page);
+	return true;
+}
 
-	// 해당 페이지 테이블에서 페이와 관련된 pml4 항목 제거 (페이지가 물리 메모리에서 제거됨)
-	pml4_clear_page(thread_current()->pml4, page->va);
+/* PAGES[0..CNT-1]의 스왑 아웃을 준비한다 (CNT <= SWAP_BATCH_MAX).
+ * frame_lock을 잡은 상태에서 호출된다 (vm_evict_frames).
+ * 스왑에 써야 하는 페이지들은 되도록 이어지는 슬롯을 받아 BATCH에 담고, 호출자가
+ * frame_lock을 놓고 swap_write_batch 한 번으로 쓴 뒤 anon_swap_out_end로 마무리한다.
+ * swap in 이후 쓰지 않은 페이지는 붙들고 있던 슬롯에 이미 같은 내용이 있으므로 쓰지 않는다.
+ * 앞에서부터 준비한 페이지 수를 반환. 스왑 공간이 모자라면 나머지 페이지는 그대로 둔다 */
+size_t
+anon_swap_out_begin (struct page *pages[], size_t cnt, struct anon_swap_batch *batch) {
+	size_t done;
+
+	ASSERT (cnt <= SWAP_BATCH_MAX);
+
+	batch->cnt = 0;
+	for (done = 0; done < cnt; done++) {
+		struct page *page = pages[done];
+		struct anon_page *anon_page = &page->anon;
+
+		// 슬롯을 받다가 잠들 수 있으므로 쓰기를 놓치지 않도록 dirty bit를 본 즉시 매핑을 끊는다
+		if (anon_page->slot != SWAP_SLOT_NONE && !pml4_is_dirty(page->owner->pml4, page->va)) {
+			pml4_clear_page(page->owner->pml4, page->va);
+			vm_stat.swap_clean_evictions++;
+			continue;
+		}
+
+		// 예전 슬롯이 있었으면 그 자리에, 앞 페이지를 쓸 슬롯이 있으면 그 다음 슬롯에,
+		// 가상 주소상 이웃한 페이지가 스왑에 있으면 그 옆 슬롯에 둔다 (readahead 효과)
+		swap_slot_t hint = batch->cnt > 0 ? batch->slots[batch->cnt - 1] + 1 : neighbor_slot_hint(page);
+		if (anon_page->slot != SWAP_SLOT_NONE) {
+			hint = anon_page->slot;
+			anon_release_slot(page);
+		}
+
+		// 스왑 공간이 가득 찼으면 메모리에 있는 페이지들이 붙들고 있는 슬롯을 거둬 온다
+		swap_slot_t slot = swap_slot_alloc(hint);
+		if (slot == SWAP_SLOT_NONE && vm_release_swap_slots())
+			slot = swap_slot_alloc(hint);
+		if (slot == SWAP_SLOT_NONE)
+			break;
+
+		anon_set_slot(page, slot);
+		batch->slots[batch->cnt] = slot;
+		batch->kvas[batch->cnt++] = page->frame->kva;
+	}
+	return done;
+}
 
-	// 복사 후 프레임과 페이지 연결 해제 -> 페이지 스왑 완료
-	page->frame->page = NULL;
-	page->frame = NULL;
+/* anon_swap_out_begin으로 준비한 PAGE의 내용이 슬롯에 들어갔으니 매핑과 프레임 연결을 끊는다 */
+void
+anon_swap_out_end (struct page *page) {
+	anon_unmap (page);
 }
 
-/* Destroy the anonymous page. PAGE will be freed by the caller. */
+/* Destroy the anonymous page. PAGE will be freed by the caller.
+ * 프레임에 올라와 있으면 프레임을 반환하고, 스왑 슬롯을 갖고 있으면 슬롯도 반환한다.
+ * 메모리에 있는 페이지도 swap in 된 슬롯을 붙들고 있을 수 있다.
+ * 프레임을 먼저 떼어내야 vm_release_swap_slots가 슬롯을 동시에 건드리지 않는다 */
 static void
 anon_destroy (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
-	free(page);
+	vm_free_frame (page);
+	anon_release_slot (page);
 }
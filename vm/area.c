@@ -0,0 +1,277 @@
+/* area.c: ELF 세그먼트와 mmap을 영역 단위로 기술하는 VMA 관리. */
+
+#include "vm/area.h"
+#include <debug.h>
+#include <round.h>
+#include "filesys/file.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "threads/pte.h"
+#include "threads/vaddr.h"
+
+/* mmap(MAP_ANYWHERE)가 빈 자리를 찾는 범위. 스택이 자랄 수 있는 1MB와
+ * 그 아래 2MB 간격을 비워 두고 위에서부터 아래로 찾는다 */
+#define MMAP_TOP ((void *) (USER_STACK - (1 << 20) - LARGE_PGSIZE))
+#define MMAP_BOTTOM ((void *) LARGE_PGSIZE)
+
+/* [START, START + LENGTH) 를 덮는 새 영역을 SPT에 추가한다.
+ * 이미 있는 영역이나 페이지와 겹치거나 메모리가 부족하면 NULL.
+ * 파일 관련 필드 (file, inode, ofs, read_bytes)는 호출자가 채운다. */
+struct vm_area *
+vm_area_create (struct supplemental_page_table *spt, void *start,
+		size_t length, enum vm_type type, bool writable, vm_initializer *init) {
+	void *end = pg_round_up (start + length);
+
+	ASSERT (pg_ofs (start) == 0);
+
+	if (length == 0 || end <= start || vm_area_overlaps (spt, start, end)
+			|| spt_find_range (spt, start, end))
+		return NULL;
+
+	struct vm_area *area = malloc (sizeof *area);
+	if (!area)
+		return NULL;
+	area->start = start;
+	area->end = end;
+	area->type = type;
+	area->writable = writable;
+	area->init = init;
+	area->file = NULL;
+	area->inode = NULL;
+	area->ofs = 0;
+	area->read_bytes = 0;
+	area->advice = MADV_NORMAL;
+	list_push_back (&spt->areas, &area->elem);
+	return area;
+}
+
+/* VA를 포함하는 영역. 없으면 NULL */
+struct vm_area *
+vm_area_find (struct supplemental_page_table *spt, const void *va) {
+	struct list_elem *e;
+
+	for (e = list_begin (&spt->areas); e != list_end (&spt->areas); e = list_next (e)) {
+		struct vm_area *area = list_entry (e, struct vm_area, elem);
+		if (area->start <= va && va < area->end)
+			return area;
+	}
+	return NULL;
+}
+
+/* [START, END) 와 겹치는 영역 중 하나. 없으면 NULL */
+struct vm_area *
+vm_area_find_overlap (struct supplemental_page_table *spt, void *start, void *end) {
+	struct list_elem *e;
+
+	for (e = list_begin (&spt->areas); e != list_end (&spt->areas); e = list_next (e)) {
+		struct vm_area *area = list_entry (e, struct vm_area, elem);
+		if (area->start < end && start < area->end)
+			return area;
+	}
+	return NULL;
+}
+
+/* [START, END) 와 겹치는 영역이 있으면 true */
+bool
+vm_area_overlaps (struct supplemental_page_table *spt, void *start, void *end) {
+	return vm_area_find_overlap (spt, start, end) != NULL;
+}
+
+/* LENGTH 바이트를 매핑할 수 있는, 영역과 페이지가 하나도 없는 자리를 위에서부터 찾는다.
+ * 2MB 이상이면 2MB 페이지로 매핑될 수 있도록 2MB 정렬된 자리를 준다. 없으면 NULL */
+void *
+vm_area_find_free (struct supplemental_page_table *spt, size_t length) {
+	uintptr_t align = length >= LARGE_PGSIZE ? LARGE_PGSIZE : PGSIZE;
+
+	length = ROUND_UP (length, PGSIZE);
+	if (length == 0 || length > (size_t) (MMAP_TOP - MMAP_BOTTOM))
+		return NULL;
+
+	void *start = (void *) ((uintptr_t) (MMAP_TOP - length) & ~(align - 1));
+	while (start >= MMAP_BOTTOM) {
+		struct vm_area *area = vm_area_find_overlap (spt, start, start + length);
+		struct page *page;
+		void *next;
+
+		// 겹치는 것이 있으면 그 아래로 옮겨 다시 확인
+		if (area)
+			next = area->start;
+		else if ((page = spt_find_range (spt, start, start + length)) != NULL)
+			next = page->va;
+		else
+			return start;
+		if (next < MMAP_BOTTOM + length)
+			break;
+		start = (void *) ((uintptr_t) (next - length) & ~(align - 1));
+	}
+	return NULL;
+}
+
+/* VA를 덮는 영역이 있으면 그 페이지의 uninit struct page를 만들어 SPT에 넣고 반환한다.
+ * aux는 예전에 load_segment/do_mmap이 페이지마다 만들던 것과 같다. 영역 밖이면 NULL */
+struct page *
+vm_area_materialize (struct supplemental_page_table *spt, void *va) {
+	struct vm_area *area = vm_area_find (spt, va);
+
+	ASSERT (spt == &thread_current ()->spt);
+
+	if (!area)
+		return NULL;
+
+	va = pg_round_down (va);
+	size_t skip = va - area->start;
+	size_t read_bytes = area->read_bytes > skip ? area->read_bytes - skip : 0;
+	if (read_bytes > PGSIZE)
+		read_bytes = PGSIZE;
+	off_t ofs = area->ofs + skip;
+	void *aux;
+
+	if (read_bytes == 0 && (VM_TYPE (area->type) == VM_ANON || (area->type & VM_PRIVATE))) {
+		// 파일에서 읽을 내용이 없는 bss 페이지는 init 없는 anon 페이지로 만들어
+		// 쓰기 전까지는 공용 zero 프레임을 매핑하게 한다
+		if (!vm_alloc_page (VM_ANON, va, area->writable))
+			return NULL;
+		return spt_find_page (spt, va);
+	} else if (area->type & (VM_TEXT | VM_PRIVATE)) {
+		struct lazy_load_aux_text *text_aux = malloc (sizeof *text_aux);
+		if (!text_aux)
+			return NULL;
+		text_aux->inode = inode_reopen (area->inode);
+		text_aux->ofs = ofs;
+		text_aux->read_bytes = read_bytes;
+		aux = text_aux;
+	} else if (VM_TYPE (area->type) == VM_FILE) {
+		struct lazy_load_aux_file *file_aux = malloc (sizeof *file_aux);
+		if (!file_aux)
+			return NULL;
+		file_aux->file = area->file;
+		file_aux->ofs = ofs;
+		file_aux->read_bytes = read_bytes;
+		file_aux->zero_bytes = PGSIZE - read_bytes;
+		file_aux->writable = area->writable;
+		file_aux->page_cnt = (area->end - area->start) / PGSIZE;
+		aux = file_aux;
+	} else {
+		struct lazy_load_aux *anon_aux = malloc (sizeof *anon_aux);
+		if (!anon_aux)
+			return NULL;
+		anon_aux->file = area->file;
+		anon_aux->ofs = ofs;
+		anon_aux->read_bytes = read_bytes;
+		anon_aux->zero_bytes = PGSIZE - read_bytes;
+		anon_aux->writable = area->writable;
+		aux = anon_aux;
+	}
+
+	if (!vm_alloc_page_with_initializer (area->type, va, area->writable, area->init, aux)) {
+		if (area->type & (VM_TEXT | VM_PRIVATE))
+			inode_close (((struct lazy_load_aux_text *) aux)->inode);
+		free (aux);
+		return NULL;
+	}
+	return spt_find_page (spt, va);
+}
+
+/* 영역을 쪼개면서 위쪽 영역으로 넘어간 PAGE가 위쪽 영역의 파일 FILE을 쓰게 한다.
+ * 아래쪽 영역이 먼저 없어지면서 원래 파일을 닫아도 PAGE가 닫힌 파일을 쓰지 않도록 */
+static void
+page_rebind_file (struct page *page, struct file *file) {
+	if (VM_TYPE (page->operations->type) == VM_UNINIT) {
+		void *aux = page->uninit.aux;
+		if (!aux || (page->uninit.type & (VM_TEXT | VM_PRIVATE)))
+			return;
+		if (VM_TYPE (page->uninit.type) == VM_FILE)
+			((struct lazy_load_aux_file *) aux)->file = file;
+		else
+			((struct lazy_load_aux *) aux)->file = file;
+	} else if (VM_TYPE (page->operations->type) == VM_FILE && page->file.file)
+		page->file.file = file;
+}
+
+/* AREA를 ADDR에서 [start, ADDR), [ADDR, end) 두 영역으로 쪼개고 위쪽 영역을 반환한다.
+ * 위쪽 영역은 자기 파일 참조를 갖고, 이미 만들어진 위쪽 페이지도 그 파일을 쓰게 바꾼다.
+ * 메모리가 부족하면 NULL이고 AREA는 그대로 */
+struct vm_area *
+vm_area_split (struct supplemental_page_table *spt, struct vm_area *area,
+		void *addr) {
+	ASSERT (pg_ofs (addr) == 0);
+	ASSERT (area->start < addr && addr < area->end);
+
+	struct vm_area *upper = malloc (sizeof *upper);
+	if (!upper)
+		return NULL;
+	*upper = *area;
+	upper->file = area->file ? file_reopen (area->file) : NULL;
+	if (area->file && !upper->file) {
+		free (upper);
+		return NULL;
+	}
+	upper->inode = inode_reopen (area->inode);
+
+	size_t skip = addr - area->start;
+	upper->start = addr;
+	upper->ofs = area->ofs + skip;
+	upper->read_bytes = area->read_bytes > skip ? area->read_bytes - skip : 0;
+	area->end = addr;
+	if (area->read_bytes > skip)
+		area->read_bytes = skip;
+	list_insert (list_next (&area->elem), &upper->elem);
+
+	if (upper->file) {
+		struct page *page;
+		for (page = spt_find_range (spt, upper->start, upper->end); page;
+				page = spt_find_range (spt, page->va + PGSIZE, upper->end))
+			page_rebind_file (page, upper->file);
+	}
+	return upper;
+}
+
+/* 영역 안에 만들어진 페이지를 모두 파괴한 뒤 (dirty mmap 페이지는 이때 파일에 쓰인다)
+ * 영역이 갖고 있던 파일 참조를 반환하고 영역을 없앤다. */
+void
+vm_area_remove (struct supplemental_page_table *spt, struct vm_area *area) {
+	struct page *page;
+
+	while ((page = spt_find_range (spt, area->start, area->end)) != NULL)
+		spt_remove_page (spt, page);
+
+	list_remove (&area->elem);
+	file_close (area->file);
+	inode_close (area->inode);
+	free (area);
+}
+
+/* fork: SRC의 영역을 DST에 복사한다. 자식은 자기 파일 참조를 갖는다 */
+bool
+vm_area_copy (struct supplemental_page_table *dst,
+		struct supplemental_page_table *src) {
+	struct list_elem *e;
+
+	for (e = list_begin (&src->areas); e != list_end (&src->areas); e = list_next (e)) {
+		struct vm_area *area = list_entry (e, struct vm_area, elem);
+		struct vm_area *copy = malloc (sizeof *copy);
+		if (!copy)
+			return false;
+
+		*copy = *area;
+		copy->file = area->file ? file_reopen (area->file) : NULL;
+		copy->inode = inode_reopen (area->inode);
+		list_push_back (&dst->areas, &copy->elem);
+		if (area->file && !copy->file)
+			return false;
+	}
+	return true;
+}
+
+/* 모든 영역을 없앤다. 영역 안의 페이지는 이미 파괴된 상태여야 한다 */
+void
+vm_area_kill (struct supplemental_page_table *spt) {
+	while (!list_empty (&spt->areas)) {
+		struct vm_area *area = list_entry (list_pop_front (&spt->areas),
+				struct vm_area, elem);
+		file_close (area->file);
+		inode_close (area->inode);
+		free (area);
+	}
+}
@@ -1,9 +1,13 @@
 /* file.c: Implementation of memory backed file object (mmaped object). */
 
+#include <string.h>
 #include "vm/vm.h"
+#include "threads/malloc.h"
 #include "threads/mmu.h"
+#include "filesys/inode.h"
 
 static bool file_backed_swap_in (struct page *page, void *kva);
+static void mmap_page_init (struct page *page, struct lazy_load_aux_file *aux);
 static bool file_backed_swap_out (struct page *page);
 static void file_backed_destroy (struct page *page);
 
@@ -32,6 +36,9 @@ file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
 	page->operations = &file_ops;
 
 	struct file_page *file_page = &page->file;
+	file_page->inode = NULL;
+	file_page->private = (type & VM_PRIVATE) != 0;
+	return true;
 }
 
 /* Swap in the page by read contents from the file.
@@ -41,8 +48,14 @@ file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
 static bool
 file_backed_swap_in (struct page *page, void *kva) {
 	struct file_page *file_page = &page->file;
+
+	// 코드 페이지는 실행 파일의 inode에서 직접 읽는다
+	if (file_page->inode) {
+		off_t read = inode_read_at(file_page->inode, kva, file_page->read_bytes, file_page->offset);
+		return read == (off_t) file_page->read_bytes;
+	}
 	file_read_at(file_page->file, kva, file_page->read_bytes, file_page->offset);
-	pml4_set_page(thread_current()->pml4, page->va, kva, page->writable);
+	return true;
 }
 
 /* Swap out the page by writeback contents to the file.
@@ -51,17 +64,31 @@ file_backed_swap_in (struct page *page, void *kva) {
  * 페이지를 교체한 후에는 페이지의 dirty bit를 꺼야 한다. */
 static bool
 file_backed_swap_out (struct page *page) {
-	struct thread *curr = thread_current();
-	struct file_page *file_page = &page->file;
+	uint64_t *pml4 = page->owner->pml4;	// 다른 프로세스의 페이지일 수도 있음
 
-	if (pml4_is_dirty(curr->pml4, page->va)) {	
-		file_write_at(file_page->file, page->frame->kva, file_page->read_bytes, file_page->offset);
-		pml4_set_dirty(curr->pml4, page->va, 0);
-	}
-	pml4_clear_page(curr->pml4, page->va);
+	file_backed_writeback(page);
+	pml4_clear_page(pml4, page->va);
 
 	page->frame->page = NULL;
 	page->frame = NULL;
+	return true;
+}
+
+/* 메모리에 올라와 있는 mmap 페이지가 dirty면 파일에 쓰고 dirty bit를 끈다.
+ * 쓰는 도중에 프레임이 사라지지 않도록 호출자가 보장해야 한다 (frame_lock 또는 pin).
+ * 실제로 썼으면 true */
+bool
+file_backed_writeback (struct page *page) {
+	struct file_page *file_page = &page->file;
+	uint64_t *pml4 = page->owner->pml4;
+
+	if (!file_page->file || !page->frame || !pml4_is_dirty(pml4, page->va))
+		return false;
+
+	// 쓰는 도중에 들어온 수정은 다음 writeback에서 다시 잡히도록 먼저 dirty bit를 끈다
+	pml4_set_dirty(pml4, page->va, false);
+	file_write_at(file_page->file, page->frame->kva, file_page->read_bytes, file_page->offset);
+	return true;
 }
 
 /* Destory the file backed page. PAGE will be freed by the caller. 
@@ -72,11 +99,47 @@ file_backed_swap_out (struct page *page) {
 static void
 file_backed_destroy (struct page *page) {
 	struct file_page *file_page = &page->file;
-	if (pml4_is_dirty(thread_current()->pml4, page->va) == 1)
-		file_write_at(file_page->file, page->va, file_page->read_bytes, file_page->offset);
-	// 스왑 인 된것만 팔록프리
-	// pml4 클리어 페이지
-	// pml4_clear_page();
+
+	// write back 하는 동안 reclaim 데몬이 프레임을 가져가지 못하도록 고정
+	if (vm_pin_page (page)) {
+		file_backed_writeback (page);
+		vm_unpin_page (page);
+	}
+	vm_free_frame (page);
+	// 코드 페이지가 갖고 있던 inode 참조 반환
+	if (file_page->inode)
+		inode_close (file_page->inode);
+}
+
+/* VM_TEXT, VM_PRIVATE 페이지의 file_page를 aux로 채운다. aux의 inode 참조는 페이지가 넘겨받음 */
+static void
+text_page_init (struct page *page, struct lazy_load_aux_text *aux) {
+	struct file_page *file_page = &page->file;
+
+	file_page->file = NULL;
+	file_page->inode = aux->inode;
+	file_page->offset = aux->ofs;
+	file_page->read_bytes = aux->read_bytes;
+	file_page->page_cnt = 0;
+	free (aux);
+}
+
+/* 실행 파일의 코드 페이지와 아직 쓰지 않은 데이터 페이지를 처음 로드 (load_segment에서 사용) */
+bool
+lazy_load_text (struct page *page, void *aux) {
+	text_page_init (page, aux);
+	return file_backed_swap_in (page, page->frame->kva);
+}
+
+/* 다른 프로세스가 이미 올려둔 코드 프레임을 공유하게 된 uninit 페이지를
+ * 파일을 다시 읽지 않고 file-backed 페이지로 초기화한다. */
+void
+file_text_attach (struct page *page) {
+	struct uninit_page *uninit = &page->uninit;
+	struct lazy_load_aux_text *aux = uninit->aux;
+
+	file_backed_initializer (page, uninit->type, page->frame->kva);
+	text_page_init (page, aux);
 }
 
 static bool lazy_load_file (struct page *page, void *aux_) {
@@ -96,88 +159,203 @@ static bool lazy_load_file (struct page *page, void *aux_) {
 	// swap in/out 과정에서 내용이 변경될 수 있기 때문에 명시적으로 다시 초기화
 	memset(page->frame->kva + page_read_bytes, 0, page_zero_bytes);
 	
-	// munmap할 때 디스크에 내용 반영해주기 위해 파일 페이지에 저장
+	mmap_page_init(page, aux);
+	return true;
+}
+
+/* munmap할 때 디스크에 내용 반영해주기 위해 aux의 정보를 파일 페이지에 저장하고 aux 해제 */
+static void
+mmap_page_init (struct page *page, struct lazy_load_aux_file *aux) {
 	page->file.file = aux->file;
 	page->file.offset = aux->ofs;
-	page->file.read_bytes = page_read_bytes;
+	page->file.read_bytes = aux->read_bytes;
 	page->file.page_cnt = aux->page_cnt;
 	free(aux);
-	
-	return true;
+}
+
+/* 빈 프레임을 high watermark 아래로 떨어뜨리지 않고 RSS 한도도 넘지 않는 선에서
+ * 물리적으로 연속된 유저 페이지를 최대 WANT 개 받는다. 받은 개수는 *CNT */
+static void *
+populate_alloc (size_t want, size_t *cnt) {
+	struct thread *curr = thread_current();
+	size_t free_cnt = palloc_user_free_cnt();
+	if (free_cnt <= vm_watermark_high)
+		return NULL;
+	if (want > free_cnt - vm_watermark_high)
+		want = free_cnt - vm_watermark_high;
+	// RSS 한도가 있으면 남은 만큼만
+	if (curr->rss_limit != 0) {
+		if (curr->rss >= curr->rss_limit)
+			return NULL;
+		if (want > curr->rss_limit - curr->rss)
+			want = curr->rss_limit - curr->rss;
+	}
+
+	for (; want > 0; want /= 2) {
+		void *kva = palloc_get_multiple(PAL_USER | PAL_ZERO, want);
+		if (kva) {
+			*cnt = want;
+			return kva;
+		}
+	}
+	return NULL;
+}
+
+/* mmap(MAP_POPULATE): ADDR부터 PAGE_CNT 개의 mmap 영역 페이지를 만들어
+ * 연속된 프레임에 file_read_at 한 번으로 읽어 들인 뒤 바로 매핑한다.
+ * 한 번에 최대 MMAP_POPULATE_CHUNK 페이지씩 읽으며, 빈 프레임이 부족해지면
+ * 나머지 페이지는 평소처럼 폴트 시 읽는다. */
+#define MMAP_POPULATE_CHUNK 64
+static void
+mmap_populate (void *addr, size_t page_cnt) {
+	struct supplemental_page_table *spt = &thread_current()->spt;
+
+	while (page_cnt > 0) {
+		size_t cnt;
+		void *kva = populate_alloc(page_cnt < MMAP_POPULATE_CHUNK ? page_cnt : MMAP_POPULATE_CHUNK, &cnt);
+		if (!kva)
+			return;
+
+		// 청크 전체를 한 번에 읽는다. 파일 끝 뒤쪽은 PAL_ZERO로 이미 0
+		size_t bytes = 0;
+		for (size_t i = 0; i < cnt; i++) {
+			struct page *page = spt_get_page(spt, addr + i * PGSIZE);
+			if (!page) {
+				palloc_free_multiple(kva, cnt);
+				return;
+			}
+			bytes += ((struct lazy_load_aux_file *) page->uninit.aux)->read_bytes;
+		}
+		struct lazy_load_aux_file *first_aux = spt_find_page(spt, addr)->uninit.aux;
+		file_read_at(first_aux->file, kva, bytes, first_aux->ofs);
+
+		for (size_t i = 0; i < cnt; i++) {
+			struct page *page = spt_find_page(spt, addr + i * PGSIZE);
+			struct lazy_load_aux_file *aux = page->uninit.aux;
+
+			file_backed_initializer(page, VM_FILE, kva + i * PGSIZE);
+			mmap_page_init(page, aux);
+			vm_install_frame(page, kva + i * PGSIZE);
+		}
+		vm_stat.populated_pages += cnt;
+		page_cnt -= cnt;
+		addr += cnt * PGSIZE;
+	}
 }
 
 /* Do the mmap
- * 성공적으로 페이지를 생성하면 addr을 반환한다.
- * 파일 타입이 FILE인 UNINIT 페이지를 생성한 후 page-fault가 발생하면
- * FILE 타입의 페이지로 초기화되며 물리프레임과 연결된다.
- * length만큼 할당 */
+ * 성공적으로 영역을 만들면 addr을 반환한다.
+ * writable에 MAP_ANYWHERE가 함께 들어오고 addr이 NULL이면 vm_area_find_free로 자리를 고른다.
+ * 페이지마다 uninit 페이지를 만드는 대신 [addr, addr + length) 를 덮는 영역 하나만 만들고,
+ * page-fault가 발생하면 그 페이지의 FILE 타입 uninit 페이지가 영역 정보로 만들어져
+ * 물리프레임과 연결된다.
+ * writable에 MAP_POPULATE가 함께 들어오면 폴트를 기다리지 않고 전체를 바로 읽어 매핑한다. */
 void *
 do_mmap (void *addr, size_t length, int writable, struct file *file, off_t offset) {
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	bool populate = writable & MAP_POPULATE;
+
+	if (!addr && (writable & MAP_ANYWHERE))
+		addr = vm_area_find_free(spt, length);
 	if (!addr)
 		return false;
+	writable &= ~(MAP_POPULATE | MAP_ANYWHERE);
 
-	struct file *new_file = file_reopen(file);	// mmap을 하는 동안 외부에서 해당 파일을 close()하는 불상사를 예외처리 하기 위함
-	void *origin_addr = addr;		// 초기 주소 저장
-	size_t origin_length = length;	// 초기 사이즈 저장
-
-	while (length > 0) {
-		struct lazy_load_aux_file *aux = malloc(sizeof(struct lazy_load_aux_file));
-
-		// 메모리 할당 오류
-		if (!aux)
-			return false;
-		
-		aux->file = new_file;
-		aux->ofs = offset;
-		aux->read_bytes = length < PGSIZE ? length : PGSIZE;
-		aux->zero_bytes = PGSIZE - aux->read_bytes;
-		aux->writable = writable;
-		aux->page_cnt = origin_length / PGSIZE;
-		
-		addr = pg_round_down(addr);
-		if (!vm_alloc_page_with_initializer(VM_FILE, addr, writable, lazy_load_file, aux)) {
-			free(aux);
-			return false;
-		}
-		length -= aux->read_bytes;
-		offset += aux->read_bytes;
-		addr += PGSIZE;
+	struct vm_area *area = vm_area_create(spt, addr, length, VM_FILE, writable, lazy_load_file);
+	if (!area)
+		return false;
+
+	// mmap을 하는 동안 외부에서 해당 파일을 close()하는 불상사를 예외처리 하기 위함
+	area->file = file_reopen(file);
+	area->ofs = offset;
+	area->read_bytes = length;
+	if (!area->file) {
+		vm_area_remove(spt, area);
+		return false;
 	}
-	return origin_addr;		// 초기 주소 반환
+
+	if (populate)
+		mmap_populate(addr, (area->end - area->start) / PGSIZE);
+	return addr;
 }
 
 /* Do the munmap
  * 연결된 물리프레임과의 연결을 끊어주는 함수
  * FILE 타입의 페이지는 file-backed 페이지이기에 디스크에 존재하는 파일과 연결된 페이지이다.
- * 해당 페이지에 수정사항이 있을 경우 이를 감지하여 변경사항을 디스크의 파일에 써줘야한다. */
+ * 해당 페이지에 수정사항이 있을 경우 이를 감지하여 변경사항을 디스크의 파일에 써줘야한다.
+ * 만들어진 페이지는 vm_area_remove가 파괴하면서 (file_backed_destroy) dirty면 파일에 쓴다. */
 void
 do_munmap (void *addr) {
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	struct vm_area *area = vm_area_find(spt, addr);
+
+	// addr이 mmap으로 받은 시작 주소일 때만 해제
+	if (!area || area->start != addr || VM_TYPE(area->type) != VM_FILE
+			|| (area->type & VM_TEXT))
+		return;
+	vm_area_remove(spt, area);
+}
+
+/* [addr, addr + length) 에 걸친 mmap 영역만 해제한다.
+ * 범위가 영역의 일부만 덮으면 영역을 쪼개서 범위 밖 부분은 남겨 둔다.
+ * 범위 안에 mmap이 아닌 영역 (ELF 세그먼트)이 있거나 메모리가 부족하면 -1 */
+int
+do_munmap_range (void *addr, size_t length) {
+	struct supplemental_page_table *spt = &thread_current()->spt;
+	void *end = pg_round_up(addr + length);
+	struct vm_area *area;
+
+	for (struct list_elem *e = list_begin(&spt->areas); e != list_end(&spt->areas); e = list_next(e)) {
+		area = list_entry(e, struct vm_area, elem);
+		if (area->start < end && addr < area->end
+				&& (VM_TYPE(area->type) != VM_FILE || (area->type & VM_TEXT)))
+			return -1;
+	}
+
+	while ((area = vm_area_find_overlap(spt, addr, end)) != NULL) {
+		// 범위 앞쪽으로 삐져나온 부분은 떼어 두고 위쪽 조각부터 다시 본다
+		if (area->start < addr) {
+			if (!vm_area_split(spt, area, addr))
+				return -1;
+			continue;
+		}
+		if (end < area->end && !vm_area_split(spt, area, end))
+			return -1;
+		vm_area_remove(spt, area);
+	}
+	return 0;
+}
+
+/* Do the msync
+ * [addr, addr + length) 에 있는 mmap 페이지 중 dirty인 것을 바로 파일에 쓴다.
+ * 아직 만들어지지 않았거나 로드되지 않았거나 쫓겨난 페이지는 이미 파일과 같으므로 건너뛴다.
+ * 범위 전체가 mmap 영역으로 덮여 있지 않으면 (스택, anon 메모리, 실행 파일 세그먼트 포함) -1 */
+int
+do_msync (void *addr, size_t length) {
 	struct thread *curr = thread_current();
-	struct page *page = spt_find_page(&curr->spt, addr);
-	struct file *file = page->file.file;
-	struct file_page *f_page = &page->file;
-
-	int cnt = f_page->page_cnt;
-
-	while (cnt > 0) {
-		page = spt_find_page(&curr->spt, addr);
-		
-		if (!page)
-			return false;
-
-		// 페이지 수정됐을 경우 (dirty bit = 1) -> 디스크의 file에 write
-		if (pml4_is_dirty(curr->pml4, addr))
-			file_write_at(file, addr, f_page->read_bytes, f_page->offset);
-		
-		pml4_clear_page(curr->pml4, addr);
-		if (page->frame) {
-			palloc_free_page(page->frame->kva);
+	void *end = addr + length;
+
+	for (void *va = addr; va < end; ) {
+		struct vm_area *area = vm_area_find(&curr->spt, va);
+
+		if (!area || VM_TYPE(area->type) != VM_FILE || (area->type & (VM_TEXT | VM_PRIVATE)))
+			return -1;
+		va = area->end;
+	}
+
+	for (void *va = addr; va < end; va += PGSIZE) {
+		struct page *page = spt_find_page(&curr->spt, va);
+
+		if (!page || VM_TYPE(page->operations->type) != VM_FILE)
+			continue;
+
+		// 쓰는 동안 reclaim 데몬이 프레임을 쫓아내지 못하도록 고정
+		// writeback 데몬이 이미 dirty bit를 끄고 쓰는 중이면 그 쓰기가 끝나야 파일에 반영된다
+		if (vm_pin_page(page)) {
+			vm_wait_io(page);
+			file_backed_writeback(page);
+			vm_unpin_page(page);
 		}
-		hash_delete(&curr->spt.hash_table, &page->hash_elem);
-		free(page);
-		
-		cnt--;
-		addr += PGSIZE;
 	}
-	file_close(file);
-}
\ No newline at end of file
+	return 0;
+}
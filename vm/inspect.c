@@ -4,7 +4,9 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
+#include "threads/palloc.h"
 #include "vm/inspect.h"
+#include "vm/vm.h"
 
 static void
 inspect (struct intr_frame *f) {
@@ -21,3 +23,70 @@ void
 register_inspect_intr (void) {
 	intr_register_int (0x42, 3, INTR_OFF, inspect, "Inspect Virtual Memory");
 }
+
+static void
+inspect_major_fault_cnt (struct intr_frame *f) {
+	f->R.rax = vm_stat.major_faults;
+}
+
+/* Tool for reading VM statistics from user programs (benchmarks).
+ * Calling this function via int 0x45.
+ * Output:
+ *   @RAX - Number of major page faults so far. */
+void
+register_vm_stat_intr (void) {
+	intr_register_int (0x45, 3, INTR_OFF, inspect_major_fault_cnt, "Inspect Major Fault Count");
+}
+
+static void
+inspect_reclaim_stat (struct intr_frame *f) {
+	switch (f->R.rax) {
+		case 0: f->R.rax = vm_watermark_low; break;
+		case 1: f->R.rax = vm_watermark_high; break;
+		case 2: f->R.rax = palloc_user_free_cnt (); break;
+		case 3: f->R.rax = vm_stat.reclaim_wakeups; break;
+		case 4: f->R.rax = vm_stat.reclaimed_frames; break;
+		case 5: f->R.rax = vm_stat.swap_readaheads; break;
+		case 6: f->R.rax = vm_stat.swap_cache_hits; break;
+		case 7: f->R.rax = vm_stat.text_shares; break;
+		case 8: f->R.rax = vm_stat.shared_evictions; break;
+		case 9: f->R.rax = vm_stat.swap_out_overlaps; break;
+		default: f->R.rax = -1; break;
+	}
+}
+
+/* Tool for reading the background reclaim state from user programs.
+ * Calling this function via int 0x46.
+ * Input:
+ *   @RAX - 0: low watermark, 1: high watermark, 2: free user frames,
+ *          3: reclaim daemon wakeups, 4: frames reclaimed by the daemon,
+ *          5: pages read ahead into the swap cache, 6: swap cache hits,
+ *          7: code frames reused from another process,
+ *          8: frames evicted from every process sharing them,
+ *          9: page faults handled while an eviction was writing to disk
+ * Output:
+ *   @RAX - Requested value, or -1 for an unknown selector. */
+void
+register_reclaim_stat_intr (void) {
+	intr_register_int (0x46, 3, INTR_OFF, inspect_reclaim_stat, "Inspect Reclaim Daemon");
+}
+
+static void
+inspect_fault_stat (struct intr_frame *f) {
+	if (f->R.rax < VM_FAULT_CLASS_CNT)
+		f->R.rax = thread_current ()->fault_cnt[f->R.rax];
+	else
+		f->R.rax = -1;
+}
+
+/* Tool for reading the calling process's page fault counters.
+ * Calling this function via int 0x47.
+ * Input:
+ *   @RAX - Fault class (enum vm_fault_class)
+ * Output:
+ *   @RAX - Faults of that class taken by the current process so far,
+ *          or -1 for an unknown class. */
+void
+register_fault_stat_intr (void) {
+	intr_register_int (0x47, 3, INTR_OFF, inspect_fault_stat, "Inspect Page Fault Classes");
+}
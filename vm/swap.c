@@ -0,0 +1,638 @@
+/* swap.c: 스왑 디스크의 페이지 단위 슬롯 관리와 readahead 스왑 캐시.
+ * 디스크 앞에는 압축 풀 (zswap.c)이 있어서 압축이 잘 되는 페이지는 디스크까지 가지 않는다.
+ * 스왑 디스크는 여러 개를 우선순위와 함께 등록할 수 있다. 우선순위가 높은 디스크의 슬롯부터
+ * 쓰고, 우선순위가 같은 디스크들에는 이어지는 슬롯을 번갈아 배치 (striping) 해서
+ * 연속된 페이지의 swap in/out이 여러 채널에서 동시에 진행되게 한다. */
+
+#include "vm/swap.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "lib/kernel/hash.h"
+#include "lib/kernel/list.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+#include "vm/zswap.h"
+
+/* 한 슬롯(페이지)이 차지하는 섹터 수 = 8 */
+#define SECTORS_PER_SLOT (PGSIZE / DISK_SECTOR_SIZE)
+
+/* 스왑 캐시가 최대로 들고 있는 페이지 수 */
+#define SWAP_CACHE_MAX 64
+
+/* 등록할 수 있는 최대 스왑 디스크 수 (IDE 채널 2개 x 디스크 2개) */
+#define SWAP_DEV_MAX 4
+
+/* 한 디스크 명령으로 옮기는 최대 페이지 수 (swap_read의 readahead 창 포함) */
+#define SWAP_RUN_MAX (1 + SWAP_CACHE_MAX)
+
+/* 스왑 디스크 하나에 내릴 연속된 섹터 명령 */
+struct swap_run {
+	disk_sector_t sec;            /* 디스크 안의 시작 섹터 */
+	void *kvas[SWAP_RUN_MAX];
+	size_t cnt;
+	bool write;
+};
+
+/* 스왑 디스크. -swap 옵션 (swap_config_disk)으로 등록하고 swap_init에서 연다 */
+struct swap_dev {
+	int chan_no, dev_no;          /* IDE 채널과 디바이스 번호. 채널마다 명령을 따로 처리한다 */
+	int prio;                     /* 클수록 먼저 쓴다 */
+	struct disk *disk;
+	size_t slot_cnt;
+	struct swap_run run;          /* 모으는 중인 명령. swap_io_lock으로 보호 */
+	struct semaphore io_start;    /* I/O 스레드에게 run을 맡긴다 */
+	struct semaphore io_done;     /* I/O 스레드가 run을 끝냈다 */
+};
+static struct swap_dev swap_devs[SWAP_DEV_MAX];
+static size_t swap_dev_cnt;
+static bool swap_multi_channel;   /* 스왑 디스크들이 두 채널 이상에 걸쳐 있음 */
+
+/* 전역 슬롯 [first, first + cnt)를 DEV_CNT개 디스크에 번갈아 배치한 구간.
+ * 구간 안의 i번째 슬롯은 devs[i % dev_cnt]의 (dev_first + i / dev_cnt)번 슬롯 */
+struct swap_stripe {
+	swap_slot_t first;
+	size_t cnt;
+	struct swap_dev *devs[SWAP_DEV_MAX];
+	size_t dev_cnt;
+	size_t dev_first;
+};
+static struct swap_stripe stripes[2 * SWAP_DEV_MAX];
+static size_t stripe_cnt;
+
+/* 같은 우선순위의 디스크들이 차지하는 전역 슬롯 [first, end)와 그 빈 슬롯 리스트의 머리.
+ * 우선순위가 높은 그룹부터 전역 슬롯 번호가 낮다 */
+struct swap_group {
+	swap_slot_t first, end;
+	swap_slot_t free_head;
+};
+static struct swap_group groups[SWAP_DEV_MAX];
+static size_t group_cnt;
+
+static size_t slot_cnt;
+
+/* 빈 슬롯들의 이중 연결 리스트 (우선순위 그룹마다 하나). free_next/free_prev[slot]은
+ * slot 다음/이전 빈 슬롯.
+ * 섹터 비트맵을 처음부터 훑는 대신 맨 앞 슬롯이나 원하는 슬롯을 O(1)에 꺼내고 돌려놓는다. */
+static swap_slot_t *free_next;
+static swap_slot_t *free_prev;
+
+/* 슬롯마다 그 슬롯을 가리키는 페이지 수. 0이면 빈 슬롯 */
+static uint16_t *slot_refs;
+
+/* 디스크 쓰기가 진행 중인 슬롯. 끝날 때까지 그 슬롯은 읽지도, 다시 쓰지도 않는다 */
+static bool *slot_busy;
+
+/* swap-in 시 요청한 슬롯 뒤로 함께 읽어 두는 슬롯 수 (커맨드라인 -swap-ra=N) */
+size_t swap_readahead = 8;
+
+/* 스왑 캐시: readahead로 미리 읽어 둔 슬롯의 내용.
+ * 슬롯 내용은 그 슬롯이 해제될 때까지 바뀌지 않으므로 그때까지 유효하다. */
+struct swap_cache_entry {
+	swap_slot_t slot;
+	void *kva;                    /* 유저 풀에서 받은 페이지 */
+	struct hash_elem hash_elem;   /* swap_cache */
+	struct list_elem list_elem;   /* swap_cache_fifo, 오래된 것부터. 읽는 중에는 읽는 스레드의 리스트 */
+	bool loading;                 /* 디스크에서 읽는 중. 아직 내용을 쓸 수 없다 */
+	bool stale;                   /* 읽는 도중 슬롯이 해제되거나 다시 쓰여서 버려야 함 */
+};
+static struct hash swap_cache;
+static struct list swap_cache_fifo;
+
+/* swap_lock은 슬롯 할당과 참조 수, 스왑 캐시, 압축 풀 같은 장부만 보호하고
+ * 디스크 전송 동안에는 잡지 않는다. 전송은 swap_io_lock 아래에서 하므로
+ * 디스크를 기다리는 동안에도 다른 스레드가 슬롯을 받거나 캐시와 압축 풀에서 읽을 수 있다 */
+static struct lock swap_lock;
+static struct lock swap_io_lock;
+static struct condition swap_io_done;   /* slot_busy가 풀렸다 (swap_lock과 함께) */
+
+/* 압축 풀에서 넘친 페이지를 풀어 디스크에 쓸 때 쓰는 커널 페이지. swap_io_lock으로 보호 */
+static void *spill_page;
+
+static uint64_t
+swap_cache_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct swap_cache_entry *entry = hash_entry (e, struct swap_cache_entry, hash_elem);
+	return hash_int (entry->slot);
+}
+
+static bool
+swap_cache_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct swap_cache_entry, hash_elem)->slot
+		< hash_entry (b, struct swap_cache_entry, hash_elem)->slot;
+}
+
+/* 커맨드라인 -swap 옵션: hdCHAN_NO:DEV_NO 디스크를 우선순위 PRIO의 스왑 디스크로 쓴다.
+ * 디스크를 찾기 전 (disk_init 이전)에 호출되므로 번호만 기억해 두고 swap_init에서 연다.
+ * 너무 많으면 false */
+bool
+swap_config_disk (int chan_no, int dev_no, int prio) {
+	if (swap_dev_cnt >= SWAP_DEV_MAX)
+		return false;
+	swap_devs[swap_dev_cnt].chan_no = chan_no;
+	swap_devs[swap_dev_cnt].dev_no = dev_no;
+	swap_devs[swap_dev_cnt].prio = prio;
+	swap_dev_cnt++;
+	return true;
+}
+
+/* 다른 채널의 스왑 디스크와 동시에 명령을 처리하기 위한 디스크별 I/O 스레드 */
+static void
+swap_io_thread (void *dev_) {
+	struct swap_dev *dev = dev_;
+
+	for (;;) {
+		sema_down (&dev->io_start);
+		if (dev->run.write)
+			disk_write_pages (dev->disk, dev->run.sec, dev->run.kvas, dev->run.cnt);
+		else
+			disk_read_pages (dev->disk, dev->run.sec, dev->run.kvas, dev->run.cnt);
+		sema_up (&dev->io_done);
+	}
+}
+
+static void
+stripe_add (struct swap_dev *devs[], size_t dev_cnt, size_t dev_first, size_t per_dev) {
+	struct swap_stripe *stripe = &stripes[stripe_cnt++];
+
+	stripe->first = slot_cnt;
+	stripe->cnt = dev_cnt * per_dev;
+	memcpy (stripe->devs, devs, dev_cnt * sizeof *devs);
+	stripe->dev_cnt = dev_cnt;
+	stripe->dev_first = dev_first;
+	slot_cnt += stripe->cnt;
+}
+
+/* 등록된 스왑 디스크들 (없으면 DEFAULT_DISK 하나)을 열고 전역 슬롯 공간을 만든다.
+ * 우선순위가 같은 디스크들은 가장 작은 디스크 크기만큼 번갈아 배치하고,
+ * 더 큰 디스크의 나머지는 그 뒤에 이어 붙인다. */
+void
+swap_init (struct disk *default_disk) {
+	bool configured = swap_dev_cnt > 0;
+
+	lock_init (&swap_lock);
+	lock_init (&swap_io_lock);
+	cond_init (&swap_io_done);
+	hash_init (&swap_cache, swap_cache_hash, swap_cache_less, NULL);
+	list_init (&swap_cache_fifo);
+
+	if (!configured && default_disk) {
+		swap_devs[0].disk = default_disk;
+		swap_dev_cnt = 1;
+	} else {
+		size_t opened = 0;
+		for (size_t i = 0; i < swap_dev_cnt; i++) {
+			struct swap_dev *dev = &swap_devs[i];
+			dev->disk = disk_get (dev->chan_no, dev->dev_no);
+			if (!dev->disk) {
+				printf ("swap: no disk hd%d:%d, ignored\n", dev->chan_no, dev->dev_no);
+				continue;
+			}
+			swap_devs[opened++] = *dev;
+		}
+		swap_dev_cnt = opened;
+	}
+
+	// 우선순위가 높은 것부터 (삽입 정렬)
+	for (size_t i = 1; i < swap_dev_cnt; i++) {
+		struct swap_dev dev = swap_devs[i];
+		size_t j = i;
+		for (; j > 0 && swap_devs[j - 1].prio < dev.prio; j--)
+			swap_devs[j] = swap_devs[j - 1];
+		swap_devs[j] = dev;
+	}
+
+	for (size_t i = 0; i < swap_dev_cnt; i++) {
+		struct swap_dev *dev = &swap_devs[i];
+		dev->slot_cnt = disk_size (dev->disk) / SECTORS_PER_SLOT;
+		if (i > 0 && dev->chan_no != swap_devs[0].chan_no)
+			swap_multi_channel = true;
+	}
+
+	for (size_t i = 0; i < swap_dev_cnt; ) {
+		struct swap_dev *devs[SWAP_DEV_MAX];
+		size_t dev_cnt = 0, min = SIZE_MAX;
+		struct swap_group *group = &groups[group_cnt++];
+
+		group->first = slot_cnt;
+		for (; i < swap_dev_cnt && (dev_cnt == 0 || swap_devs[i].prio == devs[0]->prio); i++) {
+			devs[dev_cnt++] = &swap_devs[i];
+			if (swap_devs[i].slot_cnt < min)
+				min = swap_devs[i].slot_cnt;
+		}
+		stripe_add (devs, dev_cnt, 0, min);
+		for (size_t j = 0; j < dev_cnt; j++)
+			if (devs[j]->slot_cnt > min)
+				stripe_add (&devs[j], 1, min, devs[j]->slot_cnt - min);
+		group->end = slot_cnt;
+		group->free_head = SWAP_SLOT_NONE;
+	}
+
+	if (slot_cnt == 0)
+		return;
+
+	zswap_init ();
+	spill_page = palloc_get_page (0);
+	if (!spill_page)
+		PANIC ("swap_init: out of memory for zswap spill page");
+
+	free_next = malloc (slot_cnt * sizeof *free_next);
+	free_prev = malloc (slot_cnt * sizeof *free_prev);
+	slot_refs = calloc (slot_cnt, sizeof *slot_refs);
+	slot_busy = calloc (slot_cnt, sizeof *slot_busy);
+	if (!free_next || !free_prev || !slot_refs || !slot_busy)
+		PANIC ("swap_init: out of memory for %zu swap slots", slot_cnt);
+
+	// 그룹마다 낮은 슬롯부터 나가도록 first, first + 1, ... 순서로 연결
+	for (size_t g = 0; g < group_cnt; g++) {
+		struct swap_group *group = &groups[g];
+		for (size_t i = group->first; i < group->end; i++) {
+			free_prev[i] = i > group->first ? i - 1 : SWAP_SLOT_NONE;
+			free_next[i] = i + 1 < group->end ? i + 1 : SWAP_SLOT_NONE;
+		}
+		if (group->first < group->end)
+			group->free_head = group->first;
+	}
+
+	for (size_t i = 0; i < swap_dev_cnt; i++) {
+		struct swap_dev *dev = &swap_devs[i];
+		if (configured)
+			printf ("swap: hd%d:%d, priority %d, %zu slots\n",
+					dev->chan_no, dev->dev_no, dev->prio, dev->slot_cnt);
+		sema_init (&dev->io_start, 0);
+		sema_init (&dev->io_done, 0);
+		if (swap_multi_channel)
+			thread_create ("swapio", PRI_DEFAULT, swap_io_thread, dev);
+	}
+}
+
+/* SLOT이 속한 우선순위 그룹 */
+static struct swap_group *
+slot_group (swap_slot_t slot) {
+	for (size_t g = 0; g < group_cnt; g++)
+		if (slot < groups[g].end)
+			return &groups[g];
+	NOT_REACHED ();
+}
+
+/* 빈 슬롯 SLOT을 빈 슬롯 리스트에서 뺀다. swap_lock을 잡은 상태여야 함 */
+static void
+free_list_remove (swap_slot_t slot) {
+	if (free_prev[slot] != SWAP_SLOT_NONE)
+		free_next[free_prev[slot]] = free_next[slot];
+	else
+		slot_group (slot)->free_head = free_next[slot];
+	if (free_next[slot] != SWAP_SLOT_NONE)
+		free_prev[free_next[slot]] = free_prev[slot];
+}
+
+/* SLOT을 그 그룹의 빈 슬롯 리스트 맨 앞에 넣는다. swap_lock을 잡은 상태여야 함 */
+static void
+free_list_push (swap_slot_t slot) {
+	struct swap_group *group = slot_group (slot);
+
+	free_prev[slot] = SWAP_SLOT_NONE;
+	free_next[slot] = group->free_head;
+	if (group->free_head != SWAP_SLOT_NONE)
+		free_prev[group->free_head] = slot;
+	group->free_head = slot;
+}
+
+/* 캐시 항목을 지우고 페이지를 유저 풀에 돌려준다. swap_lock을 잡은 상태여야 함.
+ * 아직 읽는 중인 항목은 찾을 수 없게만 하고, 읽기를 마친 swap_read가 버린다 */
+static void
+swap_cache_drop (struct swap_cache_entry *entry) {
+	hash_delete (&swap_cache, &entry->hash_elem);
+	if (entry->loading) {
+		entry->stale = true;
+		return;
+	}
+	list_remove (&entry->list_elem);
+	palloc_free_page (entry->kva);
+	free (entry);
+}
+
+/* SLOT의 캐시 항목. 없으면 NULL. swap_lock을 잡은 상태여야 함 */
+static struct swap_cache_entry *
+swap_cache_find (swap_slot_t slot) {
+	struct swap_cache_entry key;
+	struct hash_elem *e;
+
+	key.slot = slot;
+	e = hash_find (&swap_cache, &key.hash_elem);
+	return e ? hash_entry (e, struct swap_cache_entry, hash_elem) : NULL;
+}
+
+/* 전역 슬롯 SLOT이 있는 스왑 디스크를 반환하고, 그 디스크 안의 시작 섹터를 *SEC에 담는다 */
+static struct swap_dev *
+slot_locate (swap_slot_t slot, disk_sector_t *sec) {
+	for (size_t i = 0; i < stripe_cnt; i++) {
+		struct swap_stripe *stripe = &stripes[i];
+		if (slot >= stripe->first && slot - stripe->first < stripe->cnt) {
+			size_t idx = slot - stripe->first;
+			*sec = (stripe->dev_first + idx / stripe->dev_cnt) * SECTORS_PER_SLOT;
+			return stripe->devs[idx % stripe->dev_cnt];
+		}
+	}
+	NOT_REACHED ();
+}
+
+/* 디스크마다 모아 둔 명령을 처리한다. swap_io_lock을 잡은 상태여야 함.
+ * 처음 만난 명령과 다른 채널에 있는 디스크의 명령은 그 디스크의 I/O 스레드에 맡겨
+ * 동시에 진행하고, 같은 채널의 명령은 어차피 채널 lock으로 줄을 서므로 직접 처리한다 */
+static void
+swap_runs_flush (void) {
+	bool handed[SWAP_DEV_MAX];
+	int chan_no = -1;
+
+	for (size_t i = 0; i < swap_dev_cnt; i++) {
+		struct swap_dev *dev = &swap_devs[i];
+		handed[i] = false;
+		if (dev->run.cnt == 0)
+			continue;
+		if (chan_no == -1)
+			chan_no = dev->chan_no;
+		else if (dev->chan_no != chan_no) {
+			handed[i] = true;
+			sema_up (&dev->io_start);
+			vm_stat.swap_parallel_ios++;
+		}
+	}
+	for (size_t i = 0; i < swap_dev_cnt; i++) {
+		struct swap_dev *dev = &swap_devs[i];
+		if (dev->run.cnt == 0 || handed[i])
+			continue;
+		if (dev->run.write)
+			disk_write_pages (dev->disk, dev->run.sec, dev->run.kvas, dev->run.cnt);
+		else
+			disk_read_pages (dev->disk, dev->run.sec, dev->run.kvas, dev->run.cnt);
+	}
+	for (size_t i = 0; i < swap_dev_cnt; i++) {
+		if (handed[i])
+			sema_down (&swap_devs[i].io_done);
+		swap_devs[i].run.cnt = 0;
+	}
+}
+
+/* 이어지는 전역 슬롯 FIRST부터 CNT개를 페이지 KVAS[0..CNT-1]로 읽거나 (WRITE가 false)
+ * 거기에 쓴다. 슬롯마다 디스크와 섹터를 찾아, 같은 디스크에서 섹터가 이어지는 것끼리
+ * 명령 하나로 묶는다. swap_io_lock을 잡은 상태여야 함 */
+static void
+swap_disk_io (swap_slot_t first, void *const kvas[], size_t cnt, bool write) {
+	for (size_t i = 0; i < cnt; i++) {
+		disk_sector_t sec;
+		struct swap_dev *dev = slot_locate (first + i, &sec);
+		struct swap_run *run = &dev->run;
+
+		if (run->cnt > 0 && (run->cnt == SWAP_RUN_MAX
+					|| run->sec + run->cnt * SECTORS_PER_SLOT != sec))
+			swap_runs_flush ();
+		if (run->cnt == 0) {
+			run->sec = sec;
+			run->write = write;
+		}
+		run->kvas[run->cnt++] = kvas[i];
+	}
+	swap_runs_flush ();
+}
+
+/* 빈 슬롯 하나를 참조 1로 할당한다. 스왑 공간이 가득 찼으면 SWAP_SLOT_NONE.
+ * HINT가 비어 있으면 그 슬롯을 준다. 가상 주소상 이웃한 페이지를 이웃한 슬롯에
+ * 두어 swap-in 시 readahead가 함께 읽어 오게 하기 위함 */
+swap_slot_t
+swap_slot_alloc (swap_slot_t hint) {
+	swap_slot_t slot;
+
+	lock_acquire (&swap_lock);
+	slot = SWAP_SLOT_NONE;
+	if (hint < slot_cnt && slot_refs[hint] == 0)
+		slot = hint;
+	// 우선순위가 높은 그룹부터
+	for (size_t g = 0; g < group_cnt && slot == SWAP_SLOT_NONE; g++)
+		slot = groups[g].free_head;
+	if (slot != SWAP_SLOT_NONE) {
+		free_list_remove (slot);
+		slot_refs[slot] = 1;
+	}
+	lock_release (&swap_lock);
+	return slot;
+}
+
+/* SLOT을 가리키는 페이지가 하나 늘었다 */
+void
+swap_slot_dup (swap_slot_t slot) {
+	ASSERT (slot < slot_cnt);
+
+	lock_acquire (&swap_lock);
+	ASSERT (slot_refs[slot] > 0 && slot_refs[slot] < UINT16_MAX);
+	slot_refs[slot]++;
+	lock_release (&swap_lock);
+}
+
+/* SLOT의 참조를 하나 줄이고, 마지막 참조였으면 빈 슬롯 리스트로 돌려놓는다.
+ * 곧 다른 내용으로 덮어쓰일 수 있으므로 캐시된 내용도 버린다. */
+void
+swap_slot_free (swap_slot_t slot) {
+	ASSERT (slot < slot_cnt);
+
+	lock_acquire (&swap_lock);
+	ASSERT (slot_refs[slot] > 0);
+	if (--slot_refs[slot] == 0) {
+		struct swap_cache_entry *entry = swap_cache_find (slot);
+		if (entry)
+			swap_cache_drop (entry);
+		zswap_invalidate (slot);
+		free_list_push (slot);
+	}
+	lock_release (&swap_lock);
+}
+
+/* SLOT의 내용을 페이지 KVA로 읽는다.
+ * 압축 풀이나 스왑 캐시에 있으면 디스크를 읽지 않는다. 없으면 뒤따르는 사용 중인 슬롯을
+ * 최대 swap_readahead개까지 캐시 페이지로 받아 같은 디스크 명령으로 함께 읽는다.
+ * 디스크를 읽는 동안은 swap_lock을 놓는다. 미리 읽는 슬롯은 읽는 중 (loading)으로
+ * 캐시에 넣어 두고, 그 사이 해제되거나 다시 쓰인 슬롯의 내용은 읽은 뒤 버린다.
+ * 읽은 뒤에도 SLOT이 같은 내용을 갖고 있으면 true. 압축 풀에서 풀면서 압축본을 버렸으면
+ * 디스크의 내용은 예전 것이므로 false이고, 호출자는 슬롯을 다시 쓸 수 없다. */
+bool
+swap_read (swap_slot_t slot, void *kva) {
+	void *kvas[1 + SWAP_CACHE_MAX];
+	struct list loading;
+	size_t cnt = 1;
+
+	ASSERT (slot < slot_cnt);
+
+	lock_acquire (&swap_lock);
+	// 압축 풀에서 넘쳐 디스크로 옮겨지는 중이면 다 쓰일 때까지 기다린다
+	while (slot_busy[slot])
+		cond_wait (&swap_io_done, &swap_lock);
+	// 다른 페이지가 아직 이 슬롯을 공유하고 있으면 (fork) 압축본을 남겨 둔다
+	bool drop = slot_refs[slot] == 1;
+	if (zswap_load (slot, kva, drop)) {
+		lock_release (&swap_lock);
+		return !drop;
+	}
+	struct swap_cache_entry *entry = swap_cache_find (slot);
+	if (entry && !entry->loading) {
+		memcpy (kva, entry->kva, PGSIZE);
+		swap_cache_drop (entry);
+		vm_stat.swap_cache_hits++;
+		lock_release (&swap_lock);
+		return true;
+	}
+
+	// readahead 창: 이미 캐시돼 있거나 비어 있는 슬롯, 압축 풀에 있는 슬롯
+	// (디스크에 있는 내용은 예전 것), 쓰는 중인 슬롯을 만나면 멈춤
+	list_init (&loading);
+	kvas[0] = kva;
+	size_t window = swap_readahead < SWAP_CACHE_MAX ? swap_readahead : SWAP_CACHE_MAX;
+	while (cnt <= window) {
+		swap_slot_t next = slot + cnt;
+		if (next >= slot_cnt || slot_refs[next] == 0 || slot_busy[next]
+				|| swap_cache_find (next) || zswap_contains (next))
+			break;
+		// 캐시 때문에 다른 페이지를 쫓아내지는 않는다. 유저 풀에 여유가 있을 때만
+		void *page = palloc_get_page (PAL_USER);
+		if (!page)
+			break;
+		struct swap_cache_entry *ra = malloc (sizeof *ra);
+		if (!ra) {
+			palloc_free_page (page);
+			break;
+		}
+		ra->slot = next;
+		ra->kva = page;
+		ra->loading = true;
+		ra->stale = false;
+		hash_insert (&swap_cache, &ra->hash_elem);
+		list_push_back (&loading, &ra->list_elem);
+		kvas[cnt++] = page;
+	}
+	lock_release (&swap_lock);
+
+	lock_acquire (&swap_io_lock);
+	swap_disk_io (slot, kvas, cnt, false);
+	lock_release (&swap_io_lock);
+
+	lock_acquire (&swap_lock);
+	while (!list_empty (&loading)) {
+		struct swap_cache_entry *ra = list_entry (list_pop_front (&loading),
+				struct swap_cache_entry, list_elem);
+		if (ra->stale) {
+			palloc_free_page (ra->kva);
+			free (ra);
+			continue;
+		}
+		ra->loading = false;
+		list_push_back (&swap_cache_fifo, &ra->list_elem);
+		vm_stat.swap_readaheads++;
+	}
+	// 캐시가 넘치면 오래된 것부터 버림
+	while (hash_size (&swap_cache) > SWAP_CACHE_MAX && !list_empty (&swap_cache_fifo))
+		swap_cache_drop (list_entry (list_front (&swap_cache_fifo),
+					struct swap_cache_entry, list_elem));
+	lock_release (&swap_lock);
+	return true;
+}
+
+/* 슬롯 SLOT에 디스크 쓰기를 시작한다. swap_lock을 잡은 상태여야 함.
+ * 슬롯을 할당받은 뒤 쓰기 전에 다른 스레드의 readahead가 이 슬롯의 예전 내용을
+ * 캐시했을 수 있으므로 그 캐시와 압축 풀의 예전 내용을 버린다.
+ * 해제됐다가 다시 할당된 슬롯에 예전 쓰기가 아직 진행 중이면 끝날 때까지 기다린다 */
+static void
+swap_write_begin (swap_slot_t slot) {
+	while (slot_busy[slot])
+		cond_wait (&swap_io_done, &swap_lock);
+	struct swap_cache_entry *entry = swap_cache_find (slot);
+	if (entry)
+		swap_cache_drop (entry);
+	zswap_invalidate (slot);
+	slot_busy[slot] = true;
+}
+
+/* 슬롯 FIRST부터 CNT개의 디스크 쓰기가 끝났다. swap_lock을 잡은 상태여야 함 */
+static void
+swap_write_end (swap_slot_t first, size_t cnt) {
+	for (size_t i = 0; i < cnt; i++)
+		slot_busy[first + i] = false;
+	cond_broadcast (&swap_io_done, &swap_lock);
+}
+
+/* 페이지 KVAS[i]를 슬롯 SLOTS[i]에 쓴다 (0 <= i < CNT, CNT <= SWAP_BATCH_MAX).
+ * 압축이 잘 되면 압축 풀에만 넣고, 그 때문에 풀이 한도를 넘으면 오래된 압축 페이지부터
+ * 풀어서 디스크에 쓴다. 압축 풀에 넣지 못한 페이지 중 슬롯이 이어지는 것끼리는
+ * 디스크 명령 하나로 묶어 쓴다. 디스크에 쓰는 동안은 swap_lock을 놓는다. */
+void
+swap_write_batch (const swap_slot_t slots[], void *const kvas[], size_t cnt) {
+	bool stored[SWAP_BATCH_MAX];
+	swap_slot_t old;
+
+	ASSERT (cnt <= SWAP_BATCH_MAX);
+
+	lock_acquire (&swap_lock);
+	for (size_t i = 0; i < cnt; i++) {
+		ASSERT (slots[i] < slot_cnt);
+		stored[i] = zswap_store (slots[i], kvas[i]);
+		if (stored[i]) {
+			struct swap_cache_entry *entry = swap_cache_find (slots[i]);
+			if (entry)
+				swap_cache_drop (entry);
+		} else
+			swap_write_begin (slots[i]);
+	}
+	lock_release (&swap_lock);
+
+	lock_acquire (&swap_io_lock);
+	for (size_t i = 0; i < cnt; ) {
+		size_t run = 1;
+
+		if (stored[i]) {
+			i++;
+			continue;
+		}
+		while (i + run < cnt && !stored[i + run] && slots[i + run] == slots[i] + run)
+			run++;
+		swap_disk_io (slots[i], kvas + i, run, true);
+		i += run;
+	}
+	for (;;) {
+		lock_acquire (&swap_lock);
+		bool spilled = zswap_spill (&old, spill_page);
+		if (spilled)
+			swap_write_begin (old);
+		lock_release (&swap_lock);
+		if (!spilled)
+			break;
+		swap_disk_io (old, &spill_page, 1, true);
+		lock_acquire (&swap_lock);
+		swap_write_end (old, 1);
+		lock_release (&swap_lock);
+	}
+	lock_release (&swap_io_lock);
+
+	lock_acquire (&swap_lock);
+	for (size_t i = 0; i < cnt; i++)
+		if (!stored[i])
+			swap_write_end (slots[i], 1);
+	lock_release (&swap_lock);
+}
+
+/* 프레임이 부족할 때 vm_get_frame이 호출한다. 가장 오래된 캐시 페이지 하나를
+ * 유저 풀에 돌려주고 true 반환. 캐시가 비어 있으면 false */
+bool
+swap_cache_reclaim (void) {
+	bool reclaimed = false;
+
+	lock_acquire (&swap_lock);
+	if (!list_empty (&swap_cache_fifo)) {
+		swap_cache_drop (list_entry (list_front (&swap_cache_fifo),
+					struct swap_cache_entry, list_elem));
+		reclaimed = true;
+	}
+	lock_release (&swap_lock);
+	return reclaimed;
+}
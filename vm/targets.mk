@@ -3,3 +3,6 @@ vm_SRC += vm/uninit.c     # Uninitialized page
 vm_SRC += vm/anon.c       # Anonymous page
 vm_SRC += vm/file.c       # File mapped page
 vm_SRC += vm/inspect.c    # Testing utility
+vm_SRC += vm/swap.c       # Swap slot allocator
+vm_SRC += vm/area.c      # ELF 세그먼트/mmap 영역 (VMA)
+vm_SRC += vm/zswap.c     # 스왑 디스크 앞의 압축 페이지 풀
@@ -10,6 +10,8 @@
 
 #include "vm/vm.h"
 #include "vm/uninit.h"
+#include "threads/malloc.h"
+#include "filesys/inode.h"
 
 static bool uninit_initialize (struct page *page, void *kva);
 static void uninit_destroy (struct page *page);
@@ -62,8 +64,10 @@ uninit_initialize (struct page *page, void *kva) {
  * PAGE will be freed by the caller. */
 static void
 uninit_destroy (struct page *page) {
-	struct uninit_page *uninit UNUSED = &page->uninit;
-	/* TODO: Fill this function.
-	 * TODO: If you don't have anything to do, just return. */
-	// free(page);
+	struct uninit_page *uninit = &page->uninit;
+
+	// 한 번도 로드되지 않은 페이지의 aux는 init이 free하지 못했으므로 여기서 정리
+	if (uninit->type & (VM_TEXT | VM_PRIVATE))
+		inode_close (((struct lazy_load_aux_text *) uninit->aux)->inode);
+	free (uninit->aux);
 }
@@ -1,14 +1,92 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
+#include <stdio.h>
+#include <string.h>
+#include "intrinsic.h"
 #include "threads/malloc.h"
 #include "vm/vm.h"
 #include "vm/inspect.h"
 #include "include/lib/kernel/hash.h"
 #include "threads/mmu.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+#include "filesys/inode.h"
 
 /* frame 구조체를 관리하는 하나의 frame_table */
 struct list frame_table;
 
+/* frame_table, clock_hand, 프레임의 pages 목록과 희생 프레임 스왑 아웃을 보호한다.
+ * reclaim 데몬과 폴트를 처리하는 프로세스들이 동시에 프레임을 건드리기 때문에 필요 */
+static struct lock frame_lock;
+
+/* 프레임의 in_io가 풀렸음을 알린다. frame_lock과 함께 쓴다 */
+static struct condition frame_io_done;
+
+/* 0으로 채워진 공용 읽기 전용 프레임. init 없는 anon 페이지를 읽기만 하면 이 프레임을 매핑하고
+ * 처음 쓸 때 vm_handle_wp에서 개인 프레임을 받는다. frame_table에는 넣지 않으므로 쫓겨나지 않음 */
+static struct frame zero_frame;
+
+/* clock 알고리즘의 시계 바늘. 다음에 검사할 frame_table 원소를 가리킨다. */
+static struct list_elem *clock_hand;
+
+/* dirty한 후보를 찾은 뒤 clean한 file-backed 프레임을 더 찾아보는 최대 거리 */
+#define CLOCK_CLEAN_LOOKAHEAD 32
+
+/* 일괄 reclaim (vm_evict_frames)이 한 번의 정책 패스로 함께 쫓아내는 최대 프레임 수.
+ * anon 페이지를 swap_write_batch 한 번으로 쓰므로 SWAP_BATCH_MAX를 넘지 않는다 */
+#define EVICT_BATCH SWAP_BATCH_MAX
+
+/* OOM killer가 희생자를 고른 뒤 그 프로세스가 종료해 프레임을 내놓기를 기다리는 최대 시간 */
+#define OOM_WAIT_TICKS TIMER_FREQ	/* 1초 */
+
+/* 빈 프레임 캐시. 일괄 reclaim이 쫓아내고 바로 쓰지 않은 프레임을 내용을 0으로 정리한 채
+ * 들고 있다가 vm_get_frame이 palloc보다 먼저 꺼내 쓴다. frame_elem으로 연결하고
+ * frame_lock으로 보호한다. CPU가 하나이므로 CPU마다 두지 않고 하나만 둔다 */
+#define FRAME_CACHE_MAX 32
+static struct list frame_cache;
+static size_t frame_cache_cnt;
+
+/* frame_lock을 놓고 스왑이나 파일에 쓰고 있는 eviction 수. frame_lock으로 보호.
+ * 그동안 다른 스레드가 처리한 폴트를 vm_stat.swap_out_overlaps로 센다 */
+static int swap_out_writers;
+
+/* 실행 파일의 코드 프레임 테이블. (inode, offset) -> frame
+ * 같은 프로그램을 실행하는 프로세스들이 read-only 코드 페이지를 프레임 하나로 공유한다. */
+static struct hash text_frames;
+static uint64_t text_frame_hash (const struct hash_elem *e, void *aux);
+static bool text_frame_less (const struct hash_elem *a, const struct hash_elem *b, void *aux);
+
+/* 백그라운드 reclaim 데몬. 빈 프레임이 vm_watermark_low 아래로 내려가면 깨어나서
+ * vm_watermark_high 이상이 될 때까지 프레임을 미리 쫓아낸다 (kswapd). */
+static struct semaphore reclaim_sema;
+static bool reclaim_running;
+static void reclaim_daemon (void *aux);
+
+/* writeback 데몬. WRITEBACK_INTERVAL 마다 깨어나서 mmap된 파일 페이지 중 dirty인 것을
+ * 한 번에 WRITEBACK_BATCH 개씩 (파일, 오프셋) 순서로 정렬해 파일에 써 준다.
+ * munmap이나 종료 시점에 몰리던 쓰기를 미리 나눠서 처리한다. */
+#define WRITEBACK_INTERVAL TIMER_FREQ	/* 1초 */
+#define WRITEBACK_BATCH 32
+static void writeback_daemon (void *aux);
+
+/* working set 샘플러. WS_INTERVAL 마다 깨어나서 메모리에 올라와 있는 모든 페이지의
+ * accessed bit를 거둬들이고 지운다. 그 구간에 접근한 페이지 수를 프로세스별로 세어
+ * 반감기가 샘플 한 번인 감쇠 평균 (thread->ws_estimate)을 갱신하고,
+ * 프레임마다 최근 접근 이력 (frame->ws_age)을 남겨 clock 교체가 함께 쓴다. */
+#define WS_INTERVAL (TIMER_FREQ / 4)
+#define WS_AGE_RECENT 0x80	/* ws_age에서 가장 최근 샘플 구간에 접근했음을 나타내는 비트 */
+static unsigned ws_epoch;	/* 끝난 샘플 회차 수 */
+static size_t ws_system;	/* 시스템 전체 working set 감쇠 평균 (프레임 수) */
+static void ws_daemon (void *aux);
+
+enum vm_evict_policy vm_evict_policy = VM_EVICT_CLOCK;
+bool vm_large_pages = false;
+size_t vm_fault_around_pages = 1;
+struct vm_stat vm_stat;
+struct vm_fault_stat vm_fault_stat;
+size_t vm_watermark_low;
+size_t vm_watermark_high;
+
 /* Initializes the virtual memory subsystem by invoking each subsystem's
  * intialize codes. */
 void
@@ -20,8 +98,85 @@ vm_init (void) {
 #endif
 	register_inspect_intr ();
 	list_init(&frame_table);
+	list_init(&frame_cache);
 	/* DO NOT MODIFY UPPER LINES. */
-	/* TODO: Your code goes here. */
+	register_vm_stat_intr ();
+	register_reclaim_stat_intr ();
+	register_fault_stat_intr ();
+	clock_hand = list_end (&frame_table);
+	hash_init (&text_frames, text_frame_hash, text_frame_less, NULL);
+	lock_init (&frame_lock);
+	cond_init (&frame_io_done);
+
+	zero_frame.kva = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+	zero_frame.page = NULL;
+	list_init (&zero_frame.pages);
+	zero_frame.ref_cnt = 0;
+	zero_frame.text_inode = NULL;
+	zero_frame.pin_cnt = 1;	// eviction 대상이 아님
+
+	// 유저 풀의 1/32 아래로 떨어지면 깨어나 1/16까지 비운다
+	size_t user_pages = palloc_user_page_cnt ();
+	vm_watermark_low = user_pages / 32 + 1;
+	vm_watermark_high = user_pages / 16 + 2;
+	sema_init (&reclaim_sema, 0);
+	thread_create ("kswapd", PRI_DEFAULT, reclaim_daemon, NULL);
+	thread_create ("kflushd", PRI_DEFAULT, writeback_daemon, NULL);
+	thread_create ("kwsd", PRI_DEFAULT, ws_daemon, NULL);
+}
+
+/* VM 통계 출력 (power_off 시 print_stats에서 호출) */
+void
+vm_print_stats (void) {
+	printf ("VM: %lld major faults, %lld evictions (%lld shared), %lld cow faults, %lld shared text (%s replacement)\n",
+			vm_stat.major_faults, vm_stat.evictions, vm_stat.shared_evictions, vm_stat.cow_faults,
+			vm_stat.text_shares, vm_evict_policy == VM_EVICT_FIFO ? "fifo" : "clock");
+	printf ("VM: %lld swap readahead pages, %lld swap cache hits\n",
+			vm_stat.swap_readaheads, vm_stat.swap_cache_hits);
+	printf ("VM: %lld clean anon pages evicted without a swap write, %lld swap slots released\n",
+			vm_stat.swap_clean_evictions, vm_stat.swap_slots_released);
+	printf ("VM: %lld swap disk commands overlapped on another channel, %lld faults handled during swap-out writes\n",
+			vm_stat.swap_parallel_ios, vm_stat.swap_out_overlaps);
+	printf ("VM: %lld reclaim wakeups, %lld frames reclaimed in background\n",
+			vm_stat.reclaim_wakeups, vm_stat.reclaimed_frames);
+	printf ("VM: %lld batched eviction passes, %lld frames taken from the free-frame cache\n",
+			vm_stat.evict_batches, vm_stat.frame_cache_hits);
+	printf ("VM: %lld mmap pages written back in background, %lld zero page maps, %lld large page maps\n",
+			vm_stat.writeback_pages, vm_stat.zero_page_maps, vm_stat.large_page_maps);
+	printf ("VM: %lld pages mapped by fault-around (window %zu), %lld pages populated by mmap\n",
+			vm_stat.fault_around_pages, vm_fault_around_pages, vm_stat.populated_pages);
+	printf ("VM: working set peak %lld pages per process, %lld pages system-wide (%lld samples)\n",
+			vm_stat.ws_peak, vm_stat.ws_system_peak, vm_stat.ws_samples);
+	printf ("VM: %lld pages compressed to zswap, %lld loaded back, %lld spilled to disk, %lld incompressible\n",
+			vm_stat.zswap_stores, vm_stat.zswap_loads, vm_stat.zswap_spills, vm_stat.zswap_rejects);
+	printf ("VM: %lld frames reclaimed from processes over their RSS limit, %lld data pages made anonymous on first write\n",
+			vm_stat.rss_evictions, vm_stat.data_anon_pages);
+	printf ("VM: %lld processes killed by the OOM killer", vm_stat.oom_kills);
+	if (vm_stat.oom_kills > 0)
+		printf (" (last: %s with %zu resident, %zu swapped pages)",
+				vm_stat.oom_victim, vm_stat.oom_victim_rss, vm_stat.oom_victim_swap);
+	printf ("\n");
+	printf ("VM: madvise prefetched %lld pages, dropped %lld pages, %lld pages deactivated behind sequential scans\n",
+			vm_stat.madv_prefetched, vm_stat.madv_dropped, vm_stat.seq_deactivated);
+
+	static const char *class_names[VM_FAULT_CLASS_CNT] = {
+		"minor", "major (swap)", "major (file)", "stack growth", "write-protect", "invalid",
+	};
+	const long long *cnt = vm_fault_stat.cnt;
+	printf ("VM: page faults: %lld minor, %lld major (swap), %lld major (file), "
+			"%lld stack growth, %lld write-protect, %lld invalid\n",
+			cnt[VM_FAULT_MINOR], cnt[VM_FAULT_MAJOR_SWAP], cnt[VM_FAULT_MAJOR_FILE],
+			cnt[VM_FAULT_STACK], cnt[VM_FAULT_WP], cnt[VM_FAULT_INVALID]);
+	// 분류별 처리 시간 분포. "b:n" 은 2^b 이상 2^(b+1) 미만 사이클이 걸린 폴트가 n개
+	for (int c = 0; c < VM_FAULT_CLASS_CNT; c++) {
+		if (cnt[c] == 0)
+			continue;
+		printf ("VM: %s fault cycles (log2:count)", class_names[c]);
+		for (int b = 0; b < VM_FAULT_HIST_BUCKETS; b++)
+			if (vm_fault_stat.hist[c][b])
+				printf (" %d:%lld", b, vm_fault_stat.hist[c][b]);
+		printf ("\n");
+	}
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -39,9 +194,11 @@ page_get_type (struct page *page) {
 }
 
 /* Helpers */
-static struct frame *vm_get_victim (void);
+static struct frame *vm_get_victim (struct thread *owner);
 static bool vm_do_claim_page (struct page *page);
-static struct frame *vm_evict_frame (void);
+static bool vm_handle_wp (struct page *page);
+static struct frame *vm_evict_frames (struct thread *owner, size_t cnt);
+static bool writeback_candidate (struct page *page);
 
 /* Create the pending page object with initializer. If you want to create a
  * page, do not create it directly and make it through this function or
@@ -68,16 +225,17 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 
 		/* and then create "uninit" page struct by calling uninit_new. */
 		/* You should modify the field after calling the uninit_new. */
-		if (type == VM_ANON) {
+		if (VM_TYPE(type) == VM_ANON) {
 			uninit_new(page, upage, init, type, aux, anon_initializer);
 		}
-		else if (type == VM_FILE) {
+		else if (VM_TYPE(type) == VM_FILE) {
 			uninit_new(page, upage, init, type, aux, file_backed_initializer);
 		}
 		else {
 			return false;
 		}
 		page->writable = writable;
+		page->owner = thread_current ();
 
 		/* Insert the page into the spt. */
 		if (!spt_insert_page(spt, page))
@@ -89,24 +247,41 @@ err:
 	return false;
 }
 
+/* spt에서 VA에 해당하는 마지막 단계 슬롯의 주소를 반환한다.
+ * 중간 노드가 없으면 CREATE가 true일 때만 커널 풀에서 새로 만들고, 아니면 NULL */
+static void **
+spt_slot (struct supplemental_page_table *spt, const void *va, bool create) {
+	unsigned idx[SPT_LEVELS] = { PML4 (va), PDPE (va), PDX (va), PTX (va) };
+	void **slot = &spt->root;
+
+	for (int level = 0; level < SPT_LEVELS; level++) {
+		if (!*slot) {
+			if (!create)
+				return NULL;
+			*slot = palloc_get_page (PAL_ZERO);
+			if (!*slot)
+				return NULL;
+		}
+		slot = (void **) *slot + idx[level];
+	}
+	return slot;
+}
+
 /* Find VA from spt and return page. On error, return NULL.
  * 인자로 받은 spt로부터 va에 해당하는 page 구조체를 찾아서 반환 
  * 실패했을 경우 NULL 반환 */
 struct page *
 spt_find_page (struct supplemental_page_table *spt, void *va) {
-	// 더미 페이지 생성 및 초기화
-	struct page *dumy_page = (struct page*)malloc(sizeof(struct page));
-	struct hash_elem *elem;
-	
-	dumy_page->va = pg_round_down(va); // 주소를 인자로 가장 가까운 페이지 경계까지 내림하는 함수
-	elem = hash_find(&spt->hash_table, &dumy_page->hash_elem); // 해시 함수를 사용하여 페이지 검색
-	free(dumy_page); // 할당 해제
+	void **slot = spt_slot (spt, va, false);
+	return slot ? *slot : NULL;
+}
 
-	// 페이지를 찾았으면 페이지 포인터 반환
-	if (elem)
-		return hash_entry(elem, struct page, hash_elem);
-	else
-		return NULL;
+/* VA의 페이지를 찾고, 아직 없지만 VA가 ELF 세그먼트나 mmap 영역 안이면
+ * 영역 정보로 uninit 페이지를 만들어 반환한다. 둘 다 아니면 NULL */
+struct page *
+spt_get_page (struct supplemental_page_table *spt, void *va) {
+	struct page *page = spt_find_page (spt, va);
+	return page ? page : vm_area_materialize (spt, va);
 }
 
 /* Insert PAGE into spt with validation. 
@@ -114,96 +289,1464 @@ spt_find_page (struct supplemental_page_table *spt, void *va) {
  * 삽입에 성공하면 true, 실패하면 false */
 bool
 spt_insert_page (struct supplemental_page_table *spt, struct page *page) {
-	int succ = false;
-
 	if (!spt || !page)
 		return false;
 
-	// 해시 함수를 사용하여 페이지를 테이블에 삽입
-	struct hash_elem *elem = hash_insert(&spt->hash_table, &page->hash_elem);
+	void **slot = spt_slot (spt, page->va, true);
 
-	// elem이 null 아닐 때: 이미 페이지가 테이블에 존재 -> 삽입 실패
-	if (!elem)
-		succ = true;	// 페이지가 테이블에 존재하지 X -> 삽입 성공 !!!
-	return succ;
+	// 이미 같은 주소의 페이지가 있거나 노드를 만들 메모리가 없으면 삽입 실패
+	if (!slot || *slot)
+		return false;
+	*slot = page;
+	return true;
 }
 
 void
 spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
-	hash_delete(&spt->hash_table, &page->hash_elem);
+	void **slot = spt_slot (spt, page->va, false);
+	if (slot && *slot == page)
+		*slot = NULL;
 	vm_dealloc_page (page);
-	return true;
 }
 
-/* 대체될 구조체 프레임을 가져옵니다. (희생자 찾음) */
+/* LEVEL 단계 노드 NODE (가상 페이지 번호 BASE부터 담당) 아래에서
+ * 페이지 번호가 [LO, HI) 범위에 있는 첫 페이지를 찾는다. 비어 있는 하위 트리는 통째로 건너뛴다 */
+static struct page *
+spt_first_in (void **node, int level, uint64_t base, uint64_t lo, uint64_t hi) {
+	unsigned shift = 9 * (SPT_LEVELS - 1 - level);
+	uint64_t span = 1ULL << shift;	// 자식 하나가 담당하는 페이지 수
+	unsigned i = lo > base ? (lo - base) >> shift : 0;
+
+	for (; i < 512 && base + i * span < hi; i++) {
+		if (!node[i])
+			continue;
+		if (level == SPT_LEVELS - 1)
+			return node[i];
+		struct page *page = spt_first_in (node[i], level + 1, base + i * span, lo, hi);
+		if (page)
+			return page;
+	}
+	return NULL;
+}
+
+/* [START, END) 범위에 있는 페이지 중 주소가 가장 낮은 것을 반환. 없으면 NULL.
+ * mmap 겹침 검사와 fork/exit 시의 주소 순 순회에 쓴다 */
+struct page *
+spt_find_range (struct supplemental_page_table *spt, void *start, void *end) {
+	if (!spt->root || start >= end)
+		return NULL;
+	return spt_first_in (spt->root, 0, 0, pg_no (start), pg_no (pg_round_up (end)));
+}
+
+/* PAGE를 FRAME에 매핑된 페이지로 등록한다.
+ * 처음 등록되는 페이지가 프레임의 대표 페이지(frame->page)가 된다.
+ * 페이지 주인의 RSS에 더한다 (공유 프레임은 공유하는 프로세스마다, zero 프레임은 제외) */
+static void
+frame_link (struct frame *frame, struct page *page) {
+	list_push_back (&frame->pages, &page->frame_page_elem);
+	frame->ref_cnt++;
+	if (!frame->page)
+		frame->page = page;
+	page->frame = frame;
+	if (frame != &zero_frame)
+		page->owner->rss++;
+}
+
+/* PAGE를 자신의 프레임에서 떼어낸다. 대표 페이지였다면 남은 페이지 중 하나로 바꾼다.
+ * 프레임을 아직 매핑하고 있는 페이지 수를 반환한다. */
+static int
+frame_unlink (struct page *page) {
+	struct frame *frame = page->frame;
+
+	list_remove (&page->frame_page_elem);
+	frame->ref_cnt--;
+	if (frame != &zero_frame)
+		page->owner->rss--;
+	if (frame->page == page)
+		frame->page = frame->ref_cnt > 0
+			? list_entry (list_front (&frame->pages), struct page, frame_page_elem)
+			: NULL;
+	page->frame = NULL;
+	return frame->ref_cnt;
+}
+
+/* text_frames의 해시 함수: (inode, offset) */
+static uint64_t
+text_frame_hash (const struct hash_elem *e, void *aux UNUSED) {
+	const struct frame *frame = hash_entry (e, struct frame, text_elem);
+	return hash_bytes (&frame->text_inode, sizeof frame->text_inode)
+		^ hash_int (frame->text_ofs);
+}
+
+static bool
+text_frame_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct frame *a = hash_entry (a_, struct frame, text_elem);
+	const struct frame *b = hash_entry (b_, struct frame, text_elem);
+
+	if (a->text_inode != b->text_inode)
+		return a->text_inode < b->text_inode;
+	return a->text_ofs < b->text_ofs;
+}
+
+/* PAGE가 실행 파일의 코드 페이지(VM_TEXT)면 공유 키 (inode, offset)을 채우고 true 반환 */
+static bool
+text_page_key (struct page *page, struct inode **inode, off_t *ofs) {
+	if (VM_TYPE (page->operations->type) == VM_UNINIT) {
+		if (!(page->uninit.type & VM_TEXT))
+			return false;
+		struct lazy_load_aux_text *aux = page->uninit.aux;
+		*inode = aux->inode;
+		*ofs = aux->ofs;
+		return true;
+	}
+	if (page_get_type (page) == VM_FILE && page->file.inode && !page->file.private) {
+		*inode = page->file.inode;
+		*ofs = page->file.offset;
+		return true;
+	}
+	return false;
+}
+
+/* PAGE가 아직 쓰지 않은 ELF 데이터 페이지(VM_PRIVATE)인지.
+ * 이런 페이지는 writable이어도 읽기 전용으로 매핑해 두고 첫 쓰기에서 anon으로 바꾼다 */
+static bool
+page_is_private_file (struct page *page) {
+	if (VM_TYPE (page->operations->type) == VM_UNINIT)
+		return (page->uninit.type & VM_PRIVATE) != 0;
+	return page_get_type (page) == VM_FILE && page->file.private;
+}
+
+/* (INODE, OFS)의 코드가 이미 올라와 있는 프레임을 찾는다. 없으면 NULL */
 static struct frame *
-vm_get_victim (void) {
-	struct frame *victim = list_entry(list_pop_front(&frame_table), struct frame, frame_elem);
+text_frame_find (struct inode *inode, off_t ofs) {
+	struct frame key;
+	struct hash_elem *e;
+
+	key.text_inode = inode;
+	key.text_ofs = ofs;
+	e = hash_find (&text_frames, &key.text_elem);
+	return e ? hash_entry (e, struct frame, text_elem) : NULL;
+}
+
+/* 코드 프레임이 더 이상 (inode, offset)의 내용을 담지 않게 될 때 (해제, eviction) 테이블에서 뺀다 */
+static void
+text_frame_forget (struct frame *frame) {
+	if (frame->text_inode) {
+		hash_delete (&text_frames, &frame->text_elem);
+		frame->text_inode = NULL;
+	}
+}
+
+/* 새 프레임을 frame_table에 넣는다.
+ * clock일 때는 바늘 바로 뒤(= 한 바퀴 돈 뒤에야 검사되는 위치)에 넣는다. */
+static void
+frame_table_insert (struct frame *frame) {
+	if (vm_evict_policy == VM_EVICT_CLOCK)
+		list_insert (clock_hand, &frame->frame_elem);
+	else
+		list_push_back (&frame_table, &frame->frame_elem);
+}
+
+/* 프레임을 frame_table에서 뺀다. 바늘이 가리키던 프레임이면 바늘을 한 칸 옮긴다. */
+static void
+frame_table_remove (struct frame *frame) {
+	if (clock_hand == &frame->frame_elem)
+		clock_hand = list_next (clock_hand);
+	list_remove (&frame->frame_elem);
+}
+
+/* 바늘을 한 칸 옮긴다. 리스트 끝에 닿으면 처음으로 돌아감 */
+static struct frame *
+clock_advance (void) {
+	if (clock_hand == list_end (&frame_table))
+		clock_hand = list_begin (&frame_table);
+	struct frame *frame = list_entry (clock_hand, struct frame, frame_elem);
+	clock_hand = list_next (clock_hand);
+	return frame;
+}
+
+/* 프레임을 최근에 쓰이지 않은 것으로 돌려 다음 eviction에서 가장 먼저 검사되게 한다.
+ * clock이면 바늘 위치에, FIFO면 맨 앞에 둔다. frame_lock을 잡은 상태여야 함 */
+static void
+frame_deactivate (struct frame *frame) {
+	struct page *page = frame->page;
+
+	pml4_set_accessed (page->owner->pml4, page->va, false);
+	frame->ws_age = 0;
+	frame_table_remove (frame);
+	if (vm_evict_policy == VM_EVICT_CLOCK) {
+		list_insert (clock_hand, &frame->frame_elem);
+		clock_hand = &frame->frame_elem;
+	} else
+		list_push_front (&frame_table, &frame->frame_elem);
+}
+
+/* 쫓아내도 디스크 쓰기가 필요 없는 프레임인지 확인.
+ * anon 페이지는 swap in 된 뒤 쓰지 않아 스왑 슬롯의 내용이 그대로일 때만 clean 하다. */
+static bool
+frame_is_clean (struct frame *frame) {
+	struct page *page = frame->page;
+	enum vm_type type = page_get_type (page);
+
+	if (type == VM_ANON && page->anon.slot == SWAP_SLOT_NONE)
+		return false;
+	return (type == VM_FILE || type == VM_ANON)
+		&& !pml4_is_dirty (page->owner->pml4, page->va);
+}
+
+/* FRAME을 매핑한 페이지 중 하나라도 accessed bit가 켜져 있었으면 true. 켜진 bit는 모두 끈다.
+ * 공유 프레임은 공유하는 프로세스 중 누구도 최근에 쓰지 않았을 때만 쫓아낸다 */
+static bool
+frame_clear_accessed (struct frame *frame) {
+	bool accessed = false;
+
+	for (struct list_elem *e = list_begin (&frame->pages); e != list_end (&frame->pages);
+			e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, frame_page_elem);
+		if (pml4_is_accessed (page->owner->pml4, page->va)) {
+			pml4_set_accessed (page->owner->pml4, page->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+/* second-chance clock.
+ * 바늘이 지나가는 프레임의 accessed bit가 켜져 있으면 끄고 한 번 더 기회를 준다.
+ * accessed bit가 꺼진 프레임 중에서는 clean한 file-backed 프레임을 우선 고르고,
+ * dirty(anon 포함) 후보만 있으면 CLOCK_CLEAN_LOOKAHEAD 만큼 더 살펴본 뒤 그것을 쓴다.
+ * OWNER가 NULL이 아니면 OWNER의 프레임만 본다 (다른 프로세스의 accessed bit는 건드리지 않음) */
+static struct frame *
+vm_get_victim_clock (struct thread *owner) {
+	struct frame *dirty_victim = NULL;
+	size_t lookahead = 0;
+	size_t steps = 2 * list_size (&frame_table) + 1;
+
+	while (steps-- > 0) {
+		struct frame *frame = clock_advance ();
+		struct page *page = frame->page;
+
+		// 아직 페이지와 연결되지 않았거나 로드 중이거나 커널이 쓰고 있는 (pinned) 프레임은 건너뜀
+		if (!page || frame->pin_cnt > 0 || (owner && page->owner != owner))
+			continue;
+
+		// working set 샘플러가 accessed bit를 거둬 갔으면 ws_age에 남은 최근 접근 이력을 본다
+		if (frame_clear_accessed (frame) || (frame->ws_age & WS_AGE_RECENT)) {
+			frame->ws_age &= ~WS_AGE_RECENT;
+		} else if (frame_is_clean (frame)) {
+			return frame;
+		} else if (!dirty_victim) {
+			dirty_victim = frame;
+		}
+
+		if (dirty_victim && ++lookahead > CLOCK_CLEAN_LOOKAHEAD)
+			break;
+	}
+	return dirty_victim;
+}
+
+/* 대체될 구조체 프레임을 가져옵니다. (희생자 찾음)
+ * OWNER가 NULL이 아니면 OWNER의 프레임 중에서만 고른다.
+ * 고른 프레임은 frame_table에서 빠진 상태로 반환된다. */
+static struct frame *
+vm_get_victim (struct thread *owner) {
+	struct frame *victim = NULL;
+
+	if (list_empty (&frame_table))
+		return NULL;
+
+	if (vm_evict_policy == VM_EVICT_CLOCK)
+		victim = vm_get_victim_clock (owner);
+	else {
+		// 고정되지 않은 가장 오래된 프레임
+		for (struct list_elem *e = list_begin (&frame_table); e != list_end (&frame_table);
+				e = list_next (e)) {
+			struct frame *frame = list_entry (e, struct frame, frame_elem);
+			if (frame->page && frame->pin_cnt == 0
+					&& (!owner || frame->page->owner == owner)) {
+				victim = frame;
+				break;
+			}
+		}
+	}
+
+	if (victim)
+		frame_table_remove (victim);
 	return victim;
 }
 
-/* 한 페이지를 대체하고 해당 프레임을 반환합니다. 
- * 에러 발생 시 NULL을 반환합니다. 
+/* 쫓아낸 빈 프레임 FRAME을 빈 프레임 캐시에 넣는다. 캐시가 가득 찼으면 유저 풀에 돌려준다.
+ * frame_lock을 잡은 상태에서 호출 */
+static void
+frame_cache_put (struct frame *frame) {
+	if (frame_cache_cnt >= FRAME_CACHE_MAX) {
+		palloc_free_page (frame->kva);
+		free (frame);
+		return;
+	}
+	list_push_back (&frame_cache, &frame->frame_elem);
+	frame_cache_cnt++;
+}
+
+/* 빈 프레임 캐시에서 프레임 하나를 꺼낸다. 비어 있으면 NULL. frame_lock을 잡은 상태에서 호출 */
+static struct frame *
+frame_cache_get (void) {
+	if (list_empty (&frame_cache))
+		return NULL;
+	frame_cache_cnt--;
+	return list_entry (list_pop_front (&frame_cache), struct frame, frame_elem);
+}
+
+/* 바로 쓸 수 있는 프레임 수: 유저 풀의 빈 페이지와 빈 프레임 캐시 */
+static size_t
+free_frame_cnt (void) {
+	return palloc_user_free_cnt () + frame_cache_cnt;
+}
+
+/* 락 없이 디스크 I/O를 하려는 FRAME을 고정하고 in_io로 표시한다. frame_lock을 잡고 호출 */
+static void
+frame_start_io (struct frame *frame) {
+	frame->pin_cnt++;
+	frame->in_io = true;
+}
+
+/* frame_start_io를 되돌리고 기다리는 스레드를 깨운다. frame_lock을 잡고 호출 */
+static void
+frame_end_io (struct frame *frame) {
+	frame->pin_cnt--;
+	frame->in_io = false;
+	cond_broadcast (&frame_io_done, &frame_lock);
+}
+
+/* 여러 페이지가 공유하는 프레임 FRAME을 쫓아낼 때 대표 페이지를 정한다.
+ * anon 페이지는 파일에서 다시 읽을 수 없으므로, anon 페이지가 있으면 그중 하나를 대표로 삼아
+ * 스왑에 쓰고 나머지 anon 페이지는 그 슬롯을 함께 쓴다 (frame_evict_sharers) */
+static void
+frame_pick_evict_rep (struct frame *frame) {
+	for (struct list_elem *e = list_begin (&frame->pages); e != list_end (&frame->pages);
+			e = list_next (e)) {
+		struct page *page = list_entry (e, struct page, frame_page_elem);
+		if (page_get_type (page) == VM_ANON) {
+			frame->page = page;
+			return;
+		}
+	}
+}
+
+/* 대표 페이지 REP를 쫓아낸 공유 프레임 FRAME에서 나머지 페이지들의 매핑도 모두 끊는다.
+ * 내용은 모두 같으므로 anon 페이지는 REP의 스왑 슬롯을 함께 쓰고,
+ * 파일 페이지는 swap_out으로 (dirty면 파일에 쓴 뒤) 떼어내 다음 폴트에 파일에서 다시 읽는다.
+ * frame_lock을 잡은 상태에서 호출 */
+static void
+frame_evict_sharers (struct frame *frame, struct page *rep) {
+	while (!list_empty (&frame->pages)) {
+		struct page *page = list_entry (list_pop_front (&frame->pages),
+				struct page, frame_page_elem);
+		if (page == rep)
+			continue;
+		page->owner->rss--;
+		if (page_get_type (page) == VM_ANON) {
+			pml4_clear_page (page->owner->pml4, page->va);
+			anon_release_slot (page);
+			anon_share_slot (page, rep);
+			page->frame = NULL;
+		} else
+			swap_out (page);
+	}
+	frame->ref_cnt = 0;
+	vm_stat.shared_evictions++;
+}
+
+/* 희생 프레임을 한 번의 정책 패스로 최대 CNT개 (EVICT_BATCH 이하) 골라 함께 쫓아낸다.
+ * 스왑에 써야 하는 anon 페이지들은 anon_swap_out_begin이 슬롯을 이어서 받아 한 번에 쓰고,
+ * 나머지 페이지는 하나씩 swap_out 한다. 여러 프로세스가 공유하는 프레임 (fork 후 COW, 실행 파일 코드)은
+ * 대표 페이지를 내보낸 뒤 나머지 페이지의 매핑도 모두 끊는다.
+ * 스왑과 파일에 쓰는 동안은 frame_lock을 놓는다. 그 전에 희생 프레임을 매핑한 페이지를 모두
+ * 매핑 해제하고 프레임을 in_io로 고정해 두므로, 그 페이지에 접근하는 폴트와 해제는
+ * 쓰기가 끝날 때까지 기다렸다가 (vm_wait_io, vm_free_frame) 스왑이나 파일에서 다시 읽는다.
+ * 쫓아낸 첫 프레임을 반환하고 나머지는 빈 프레임 캐시에 넣는다. 하나도 못 쫓아내면 NULL.
+ * frame_lock을 잡은 상태에서 호출 
  * 스왑 대상: 프레임이 아닌 프레임과 연결된 페이지!!! */
 static struct frame *
-vm_evict_frame (void) {
-	struct frame *victim = vm_get_victim (); // 하나의 프레임 받아옴
+vm_evict_frames (struct thread *owner, size_t cnt) {
+	struct frame *victims[EVICT_BATCH];
+	struct thread *owners[EVICT_BATCH];
+	struct page *reps[EVICT_BATCH];
+	struct page *anon_pages[EVICT_BATCH];
+	struct page *wb_pages[EVICT_BATCH];
+	struct anon_swap_batch batch;
+	size_t victim_cnt = 0, anon_cnt = 0, anon_done, anon_idx = 0;
+	bool io = false;
+	struct frame *first = NULL;
+
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+
+	if (cnt > EVICT_BATCH)
+		cnt = EVICT_BATCH;
+
+	// 고른 프레임은 frame_table에서 빠지므로 같은 프레임을 두 번 고르지 않는다
+	while (victim_cnt < cnt) {
+		struct frame *victim = vm_get_victim (owner);
+		if (!victim)
+			break;
+		if (victim->ref_cnt > 1)
+			frame_pick_evict_rep (victim);
+		// swap_out이 프레임과 페이지의 연결을 직접 끊으므로 RSS를 뺄 주인을 미리 기억
+		owners[victim_cnt] = victim->page->owner;
+		reps[victim_cnt] = victim->page;
+		victims[victim_cnt++] = victim;
+		if (page_get_type (victim->page) == VM_ANON)
+			anon_pages[anon_cnt++] = victim->page;
+	}
+	if (victim_cnt > 1)
+		vm_stat.evict_batches++;
+
+	anon_done = anon_swap_out_begin (anon_pages, anon_cnt, &batch);
+
+	for (size_t i = 0; i < victim_cnt; i++) {
+		struct frame *victim = victims[i];
+
+		// 스왑 공간이 모자라 슬롯을 받지 못한 anon 페이지의 프레임은 되돌려 놓는다
+		if (page_get_type (reps[i]) == VM_ANON && anon_idx++ >= anon_done) {
+			frame_table_insert (victim);
+			victims[i] = NULL;
+			continue;
+		}
+
+		// 락을 놓은 동안 다른 프로세스가 이 코드 프레임을 찾아 매핑하지 않도록 먼저 뺀다
+		frame_start_io (victim);
+		text_frame_forget (victim);
+		wb_pages[i] = NULL;
+		for (struct list_elem *e = list_begin (&victim->pages); e != list_end (&victim->pages);
+				e = list_next (e)) {
+			struct page *page = list_entry (e, struct page, frame_page_elem);
+			if (page->owner->pml4)
+				pml4_clear_page (page->owner->pml4, page->va);
+			// 매핑을 끊어도 dirty bit는 남아 있으므로 writeback은 락 없이 해도 된다
+			if (!wb_pages[i] && writeback_candidate (page))
+				wb_pages[i] = page;
+		}
+		if (wb_pages[i])
+			io = true;
+	}
+
+	if (batch.cnt > 0 || io) {
+		swap_out_writers++;
+		lock_release (&frame_lock);
+		swap_write_batch (batch.slots, batch.kvas, batch.cnt);
+		for (size_t i = 0; i < victim_cnt; i++)
+			if (victims[i] && wb_pages[i])
+				file_backed_writeback (wb_pages[i]);
+		lock_acquire (&frame_lock);
+		swap_out_writers--;
+	}
+
+	for (size_t i = 0; i < victim_cnt; i++) {
+		struct frame *victim = victims[i];
+
+		if (!victim)
+			continue;
+		frame_end_io (victim);
+		if (page_get_type (reps[i]) == VM_ANON)
+			anon_swap_out_end (reps[i]);
+		else
+			swap_out (reps[i]);
+		owners[i]->rss--;
+		if (victim->ref_cnt > 1)
+			frame_evict_sharers (victim, reps[i]);
+		vm_stat.evictions++;
+		memset(victim->kva, 0, PGSIZE);	// PAL_ZERO로 받은 프레임과 똑같이 0으로 정리
+		if (!first)
+			first = victim;
+		else
+			frame_cache_put (victim);
+	}
+	return first;	// 빈 프레임 반환
+}
+
+/* 빈 프레임이 low watermark 아래로 떨어졌으면 reclaim 데몬을 깨운다 */
+static void
+reclaim_wakeup (void) {
+	if (!reclaim_running && free_frame_cnt () < vm_watermark_low) {
+		reclaim_running = true;
+		sema_up (&reclaim_sema);
+	}
+}
+
+/* reclaim 데몬 본체. 깨어나면 빈 프레임이 high watermark에 닿을 때까지
+ * 먼저 readahead로 미리 읽어 둔 스왑 캐시 페이지를 유저 풀에 돌려주고,
+ * 그래도 모자라면 희생 프레임을 한 번에 여러 개씩 골라 스왑 아웃하고 빈 프레임 캐시를 채운다.
+ * 캐시가 가득 차면 나머지는 유저 풀에 돌려준다.
+ * 덕분에 폴트를 처리하는 스레드는 보통 캐시나 palloc만으로 프레임을 얻는다. */
+static void
+reclaim_daemon (void *aux UNUSED) {
+	for (;;) {
+		sema_down (&reclaim_sema);
+		vm_stat.reclaim_wakeups++;
+
+		// 추측으로 읽어 둔 페이지 때문에 프로세스가 쓰고 있는 페이지가 쫓겨나지 않도록
+		while (free_frame_cnt () < vm_watermark_high && swap_cache_reclaim ())
+			continue;
+
+		while (free_frame_cnt () < vm_watermark_high) {
+			lock_acquire (&frame_lock);
+			long long evictions = vm_stat.evictions;
+			struct frame *victim = vm_evict_frames (NULL, vm_watermark_high - free_frame_cnt ());
+			if (victim)
+				frame_cache_put (victim);
+			vm_stat.reclaimed_frames += vm_stat.evictions - evictions;
+			lock_release (&frame_lock);
+
+			// 쫓아낼 프레임이 없으면 (모두 공유/로드 중이거나 스왑 공간 부족) 다음 기회에
+			if (!victim)
+				break;
+		}
+		reclaim_running = false;
+	}
+}
+
+/* writeback 대상인지 확인: 메모리에 올라와 있는 dirty mmap 페이지 */
+static bool
+writeback_candidate (struct page *page) {
+	return VM_TYPE (page->operations->type) == VM_FILE
+		&& page->file.file != NULL
+		&& pml4_is_dirty (page->owner->pml4, page->va);
+}
+
+/* 파일 안에서 인접한 페이지가 연달아 쓰이도록 (inode, offset) 순으로 비교 */
+static bool
+writeback_less (struct page *a, struct page *b) {
+	struct inode *ia = file_get_inode (a->file.file);
+	struct inode *ib = file_get_inode (b->file.file);
+	if (ia != ib)
+		return ia < ib;
+	return a->file.offset < b->file.offset;
+}
+
+/* PAGE의 프레임에서 락 없이 진행 중인 디스크 I/O가 끝날 때까지 기다린다. 기다렸으면 true */
+bool
+vm_wait_io (struct page *page) {
+	bool waited = false;
+
+	lock_acquire (&frame_lock);
+	while (page->frame && page->frame->in_io) {
+		cond_wait (&frame_io_done, &frame_lock);
+		waited = true;
+	}
+	lock_release (&frame_lock);
+	return waited;
+}
+
+/* dirty mmap 페이지를 최대 WRITEBACK_BATCH 개 골라 정렬한 뒤 파일에 쓴다.
+ * frame_lock 아래에서 고르고 dirty bit를 끈 뒤 프레임을 in_io로 고정하고,
+ * 파일 쓰기는 락을 놓고 한다. 그 사이 폴트와 eviction은 계속 진행되고,
+ * 고정된 프레임은 쫓겨나지 않으며 munmap이나 종료로 페이지가 파괴될 때는
+ * vm_free_frame이 쓰기가 끝날 때까지 기다리므로 페이지와 파일도 그대로 남아 있다.
+ * 모은 페이지 수를 반환 (BATCH와 같으면 더 남아 있을 수 있음) */
+static size_t
+writeback_pass (void) {
+	struct page *batch[WRITEBACK_BATCH];
+	struct frame *frames[WRITEBACK_BATCH];
+	size_t cnt = 0;
+
+	lock_acquire (&frame_lock);
+	for (struct list_elem *e = list_begin (&frame_table);
+			e != list_end (&frame_table) && cnt < WRITEBACK_BATCH; e = list_next (e)) {
+		struct frame *frame = list_entry (e, struct frame, frame_elem);
+		struct page *page = frame->page;
+
+		if (!page || frame->pin_cnt > 0 || !writeback_candidate (page))
+			continue;
+
+		// 삽입 정렬
+		size_t i = cnt++;
+		for (; i > 0 && writeback_less (page, batch[i - 1]); i--)
+			batch[i] = batch[i - 1];
+		batch[i] = page;
+	}
+
+	// 쓰는 도중에 들어온 수정은 다음 writeback에서 다시 잡히도록 먼저 dirty bit를 끈다
+	for (size_t i = 0; i < cnt; i++) {
+		frames[i] = batch[i]->frame;
+		pml4_set_dirty (batch[i]->owner->pml4, batch[i]->va, false);
+		frame_start_io (frames[i]);
+	}
+	lock_release (&frame_lock);
+
+	for (size_t i = 0; i < cnt; i++) {
+		struct file_page *file_page = &batch[i]->file;
+		file_write_at (file_page->file, frames[i]->kva, file_page->read_bytes, file_page->offset);
+	}
+
+	lock_acquire (&frame_lock);
+	for (size_t i = 0; i < cnt; i++)
+		frame_end_io (frames[i]);
+	vm_stat.writeback_pages += cnt;
+	lock_release (&frame_lock);
+	return cnt;
+}
+
+static void
+writeback_daemon (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (WRITEBACK_INTERVAL);
+		while (writeback_pass () == WRITEBACK_BATCH)
+			continue;
+	}
+}
+
+/* T의 working set 추정치를 현재 샘플 회차까지 갱신한다. 마지막으로 접근이 잡힌 뒤
+ * 지나간 회차는 접근 0으로 감쇠시킨다. frame_lock을 잡은 상태에서 호출 */
+static void
+ws_catch_up (struct thread *t) {
+	if (ws_epoch - t->ws_epoch > 32) {
+		t->ws_estimate = 0;
+		t->ws_sample = 0;
+		t->ws_epoch = ws_epoch;
+	}
+	for (; t->ws_epoch != ws_epoch; t->ws_epoch++) {
+		t->ws_estimate = (t->ws_estimate + t->ws_sample) / 2;
+		t->ws_sample = 0;
+		if ((long long) t->ws_estimate > vm_stat.ws_peak)
+			vm_stat.ws_peak = t->ws_estimate;
+	}
+}
+
+/* 샘플 한 회차. 먼저 모든 페이지의 accessed bit를 읽어 프레임의 ws_age와 소유 프로세스의
+ * 샘플 수를 갱신한 뒤 bit를 지운다. 2MB 페이지는 512개 프레임이 PDE의 bit 하나를 함께 쓰므로
+ * 읽기를 모두 마친 뒤에 지워야 한다. */
+static void
+ws_sample (void) {
+	struct list_elem *e, *pe;
+	size_t referenced = 0;
+
+	lock_acquire (&frame_lock);
+	for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e)) {
+		struct frame *frame = list_entry (e, struct frame, frame_elem);
+		bool accessed = false;
+
+		for (pe = list_begin (&frame->pages); pe != list_end (&frame->pages); pe = list_next (pe)) {
+			struct page *page = list_entry (pe, struct page, frame_page_elem);
+			if (!pml4_is_accessed (page->owner->pml4, page->va))
+				continue;
+			ws_catch_up (page->owner);
+			page->owner->ws_sample++;
+			accessed = true;
+		}
+		frame->ws_age = (frame->ws_age >> 1) | (accessed ? WS_AGE_RECENT : 0);
+		if (accessed)
+			referenced++;
+	}
+	for (e = list_begin (&frame_table); e != list_end (&frame_table); e = list_next (e)) {
+		struct frame *frame = list_entry (e, struct frame, frame_elem);
+		if (!(frame->ws_age & WS_AGE_RECENT))
+			continue;
+		for (pe = list_begin (&frame->pages); pe != list_end (&frame->pages); pe = list_next (pe)) {
+			struct page *page = list_entry (pe, struct page, frame_page_elem);
+			pml4_set_accessed (page->owner->pml4, page->va, false);
+		}
+	}
+	ws_epoch++;
+	ws_system = (ws_system + referenced) / 2;
+	if ((long long) ws_system > vm_stat.ws_system_peak)
+		vm_stat.ws_system_peak = ws_system;
+	vm_stat.ws_samples++;
+	lock_release (&frame_lock);
+}
+
+static void
+ws_daemon (void *aux UNUSED) {
+	for (;;) {
+		timer_sleep (WS_INTERVAL);
+		ws_sample ();
+	}
+}
+
+/* 현재 프로세스의 working set 추정치 (페이지 수) */
+size_t
+vm_working_set (void) {
+	struct thread *curr = thread_current ();
+
+	lock_acquire (&frame_lock);
+	ws_catch_up (curr);
+	size_t estimate = curr->ws_estimate;
+	lock_release (&frame_lock);
+	return estimate;
+}
+
+/* 새로 받은 프레임을 초기화하고 (pinned 상태로) frame_table에 추가 */
+static void
+frame_prepare (struct frame *frame) {
+	frame->page = NULL;			// 새로운 프레임 초기화
+	list_init (&frame->pages);
+	frame->ref_cnt = 0;
+	frame->text_inode = NULL;
+	frame->pin_cnt = 1;		// 내용을 다 채울 때까지 쫓겨나지 않도록
+	frame->in_io = false;
+	frame->ws_age = 0;
+
+	// 할당 받은 frame을 frame_table에 추가
+	frame_table_insert (frame);
+}
+
+/* T가 RSS 한도를 정했고 이미 한도만큼 프레임을 갖고 있으면 true */
+static bool
+rss_over_limit (struct thread *t) {
+	return t->rss_limit != 0 && t->rss >= t->rss_limit;
+}
+
+/* 빈 프레임 캐시, 유저 풀, eviction 순서로 빈 프레임을 하나 얻는다.
+ * eviction이 디스크에 쓰는 동안은 frame_lock을 놓는다.
+ * 쫓아낼 프레임이 없거나 스왑 공간이 모자라면 NULL */
+static struct frame *
+frame_try_get (void) {
+	struct frame *new_frame;
+
+	// 일괄 reclaim이 남겨 둔 빈 프레임부터 쓴다
+	new_frame = frame_cache_get ();
+	if (new_frame) {
+		vm_stat.frame_cache_hits++;
+		return new_frame;
+	}
+
+	// new_frame의 kva에 user pool의 페이지 할당
+	// anonymous case를 위해 PAL_ZERO 플래그 설정(프레임 내용 0으로 초기화)
+	void *kva = palloc_get_page(PAL_USER | PAL_ZERO);	// 물리 메모리 할당 후 그 위치의 kva 반환
+
+	// 페이지를 쫓아내기 전에 readahead로 미리 읽어 둔 스왑 캐시부터 비운다
+	while (!kva && swap_cache_reclaim ())
+		kva = palloc_get_page(PAL_USER | PAL_ZERO);
+
+	if (kva) {
+		new_frame = (struct frame *)malloc(sizeof(struct frame));	// 할당하기 위한 유저 물리 메모리 프레임 생성
+		if (!new_frame)
+			PANIC ("vm_get_frame: out of kernel memory");
+		new_frame->kva = kva;
+		return new_frame;
+	}
+
+	// user pool이 다 찼다는 뜻(모두 사용중)이므로 evicted_frame으로 빈자리 만들어줌
+	// 페이지 swap out 기법을 사용하여 새로운 물리 메모리 할당: 삭제할 페이지 디스크로 이동
+	// 한 번에 여러 개를 쫓아내 나머지는 캐시에 두므로 다음 폴트들은 바로 프레임을 얻는다
+	// reclaim 데몬이 제때 비워두면 이 경로는 거의 타지 않는다
+	return vm_evict_frames(NULL, EVICT_BATCH);	// 페이지 스왑아웃을 수행하여 빈 프레임 반환
+}
+
+/* oom_select_victim이 thread_foreach로 모든 스레드를 훑으며 지금까지 찾은 후보를 담아 두는 곳 */
+struct oom_candidate {
+	struct thread *victim;
+	size_t score;
+};
+
+/* T의 점수 (rss + swap_pages)가 지금까지의 후보보다 크면 T를 후보로 삼는다.
+ * 이미 희생자로 골라 둔 프로세스와 메모리를 갖고 있지 않은 스레드 (커널 스레드, 종료 중인 프로세스)는 건너뛴다. */
+static void
+oom_rank_thread (struct thread *t, void *aux) {
+	struct oom_candidate *cand = aux;
+	size_t score = t->rss + t->swap_pages;
+
+	if (t->oom_killed || score == 0)
+		return;
+	if (!cand->victim || score > cand->score) {
+		cand->victim = t;
+		cand->score = score;
+	}
+}
+
+/* OOM killer가 고를 희생자. 살아있는 모든 프로세스 중에서 메모리에 있는 페이지 수 (rss)와
+ * 스왑 슬롯 수 (swap_pages)의 합이 가장 큰 프로세스를 고른다 (대부분 스왑 아웃된 프로세스도 후보가 된다).
+ * 이미 골라 둔 희생자는 다시 고르지 않는다. 후보가 없으면 NULL. */
+static struct thread *
+oom_select_victim (void) {
+	struct oom_candidate cand = { NULL, 0 };
+	enum intr_level old_level;
+
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+
+	old_level = intr_disable ();
+	thread_foreach (oom_rank_thread, &cand);
+	intr_set_level (old_level);
+	return cand.victim;
+}
+
+/* 프레임도 스왑 공간도 없을 때 희생자 프로세스를 골라 종료시키고, 그 프로세스가
+ * 프레임과 스왑 슬롯을 내놓을 때까지 OOM_WAIT_TICKS 동안 기다리며 다시 프레임을 얻어 본다.
+ * 다른 스레드를 그 자리에서 없앨 수는 없으므로 희생자는 oom_killed 표시만 해 두고,
+ * 유저 모드로 돌아가기 전에 (page fault, 시스템 콜, 타이머 인터럽트) 스스로 exit(-1) 한다.
+ * wait()처럼 sema_down_killable()로 잠들어 있는 희생자는 thread_interrupt()로 깨워 바로 종료하게 하고,
+ * 락이나 디스크를 기다리는 희생자는 그 시스템 콜이나 폴트를 마치고 유저로 돌아갈 때 종료한다.
+ * 희생자가 현재 프로세스이거나, 고를 희생자가 없거나, 기다려도 프레임이 나오지 않으면 NULL.
+ * 기다리는 동안은 frame_lock을 놓는다. */
+static struct frame *
+vm_oom_reclaim (void) {
+	struct thread *victim = oom_select_victim ();
+	struct frame *frame = NULL;
 
 	if (!victim)
 		return NULL;
+	victim->oom_killed = true;
+	vm_stat.oom_kills++;
+	strlcpy (vm_stat.oom_victim, victim->name, sizeof vm_stat.oom_victim);
+	vm_stat.oom_victim_rss = victim->rss;
+	vm_stat.oom_victim_swap = victim->swap_pages;
+	if (victim == thread_current ())
+		return NULL;
+	thread_interrupt (victim);
 
-	swap_out(victim->page);	// 페이지 스왑 아웃
-	memset(victim->kva, 0, PGSIZE);	// 쓰던거 정리..?	
-	return victim;	// 빈 프레임 반환
+	// 희생자가 종료하면서 frame_lock을 잡고 프레임을 돌려주므로 락을 놓고 기다린다.
+	// 락을 놓은 뒤에는 희생자가 이미 사라졌을 수 있으므로 victim을 다시 보지 않는다
+	for (int i = 0; i < OOM_WAIT_TICKS && !frame; i++) {
+		lock_release (&frame_lock);
+		timer_sleep (1);
+		lock_acquire (&frame_lock);
+		frame = frame_try_get ();
+	}
+	return frame;
 }
 
 /* 유저풀에서 palloc_get_page를 호출함으로써 새로운 물리 페이지를 가져온다.
  * palloc() 함수는 페이지 프레임을 할당하고 해당 프레임을 반환합니다.
  * 사용 가능한 페이지가 없는 경우 페이지를 대체하고 해당 페이지를 반환합니다.
- * 이 함수는 항상 유효한 주소를 반환합니다.
- * 다시 말해, 유저풀 메모리가 가득 차 있는 경우 사용 가능한 메모리 공간을 확보하기 위해 페이지를 대체합니다.*/
+ * 다시 말해, 유저풀 메모리가 가득 차 있는 경우 사용 가능한 메모리 공간을 확보하기 위해 페이지를 대체합니다.
+ * 쫓아낼 프레임도 스왑 공간도 없으면 OOM killer로 프로세스 하나를 종료시켜 프레임을 얻고,
+ * 그래도 얻지 못하면 NULL을 반환한다 (호출한 폴트는 실패하고 프로세스가 종료된다).
+ * frame_lock을 잡은 상태에서 호출하며, eviction이 디스크에 쓰는 동안과 OOM 상황에서는
+ * 잠시 frame_lock을 놓았다가 다시 잡는다.
+ * 반환된 프레임은 한 번 pin 된 상태이므로 내용을 채운 뒤 pin_cnt를 줄여야 eviction 대상이 된다.
+ * 프레임을 받을 페이지의 주인 OWNER가 RSS 한도에 닿았으면 다른 프로세스의 페이지 대신
+ * OWNER 자신의 페이지를 내보내고 그 프레임을 준다. */
 static struct frame *
-vm_get_frame (void) {
-	struct frame *new_frame = (struct frame *)malloc(sizeof(struct frame));	// 할당하기 위한 유저 물리 메모리 프레임 생성
+vm_get_frame (struct thread *owner) {
+	struct frame *new_frame = NULL;
 
-	// new_frame의 kva에 user pool의 페이지 할당
-	// anonymous case를 위해 PAL_ZERO 플래그 설정(프레임 내용 0으로 초기화)
-	new_frame->kva = palloc_get_page(PAL_USER | PAL_ZERO);	// 물리 메모리 할당 후 그 위치의 kva 반환
-	
-	// user pool로부터 물리 메모리 할당 실패 시
-	if (!new_frame || !new_frame->kva) {
-		if (!new_frame)
-			free(new_frame);
-		// user pool이 다 찼다는 뜻(모두 사용중)이므로 evicted_frame으로 빈자리 만들어줌
-		// 페이지 swap out 기법을 사용하여 새로운 물리 메모리 할당: 삭제할 페이지 디스크로 이동
-		new_frame = vm_evict_frame();	// 페이지 스왑아웃을 수행하여 빈 프레임 반환
-		new_frame->page = NULL;			// 새로운 프레임 초기화
-		// return new_frame;
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+
+	// 한도에 닿은 프로세스는 자기 페이지를 하나만 내보낸다 (working set을 한꺼번에 잃지 않도록)
+	if (rss_over_limit (owner)) {
+		new_frame = vm_evict_frames (owner, 1);
+		if (new_frame)
+			vm_stat.rss_evictions++;
 	}
 
-	// 할당 받은 frame을 frame_table에 추가
-	list_push_back(&frame_table, &new_frame->frame_elem);
-	new_frame->page = NULL;
+	if (!new_frame)
+		new_frame = frame_try_get ();
+	if (!new_frame)
+		new_frame = vm_oom_reclaim ();
+	if (!new_frame)
+		return NULL;
+	reclaim_wakeup ();
+	frame_prepare (new_frame);
 
-	ASSERT (new_frame != NULL);
 	ASSERT (new_frame->page == NULL);
 	
 	return new_frame;	// 물리 메모리 프레임 성공적으로 할당 시 프레임 포인터 반환
 }
 
+/* 호출자가 유저 풀에서 받아 내용을 이미 채워 둔 KVA를 PAGE의 프레임으로 등록하고 매핑한다.
+ * mmap(MAP_POPULATE)처럼 여러 페이지를 한 번에 읽어 들일 때 사용.
+ * PAGE는 이미 최종 타입으로 초기화돼 있어야 한다 (등록 즉시 eviction 대상이 됨) */
+void
+vm_install_frame (struct page *page, void *kva) {
+	struct frame *frame = malloc (sizeof *frame);
+	if (!frame)
+		PANIC ("vm_install_frame: out of kernel memory");
+	frame->kva = kva;
+
+	lock_acquire (&frame_lock);
+	frame_prepare (frame);
+	frame_link (frame, page);
+	if (!pml4_set_page (page->owner->pml4, page->va, kva, page->writable))
+		PANIC ("vm_install_frame: out of page table memory");
+	frame->pin_cnt--;
+	reclaim_wakeup ();
+	lock_release (&frame_lock);
+}
+
+/* PAGE가 프레임에 올라와 있으면 그 프레임의 pin_cnt를 올려 eviction과 reclaim 데몬이
+ * 쫓아내지 못하게 한다. 이미 쫓겨났으면 false.
+ * 고정한 쪽은 vm_unpin_page로 풀거나, 풀지 않고 vm_free_frame으로 프레임을 반환한다. */
+bool
+vm_pin_page (struct page *page) {
+	lock_acquire (&frame_lock);
+	// 쫓겨나는 중이면 쓰기가 끝난 뒤에 보아야 쫓겨난 프레임을 고정하지 않는다
+	while (page->frame && page->frame->in_io)
+		cond_wait (&frame_io_done, &frame_lock);
+	bool resident = page->frame != NULL;
+	if (resident)
+		page->frame->pin_cnt++;
+	lock_release (&frame_lock);
+	return resident;
+}
+
+/* vm_pin_page로 고정한 PAGE의 프레임을 다시 eviction 대상으로 돌린다.
+ * 다른 곳에서도 고정했으면 모두 풀릴 때까지 계속 고정 상태 */
+void
+vm_unpin_page (struct page *page) {
+	lock_acquire (&frame_lock);
+	if (page->frame && page->frame->pin_cnt > 0)
+		page->frame->pin_cnt--;
+	lock_release (&frame_lock);
+}
+
+/* 시스템 콜이 유저 버퍼 [UADDR, UADDR + SIZE)를 직접 읽고 쓰기 전에 버퍼의 페이지를
+ * 모두 메모리에 올리고 고정한다. file lock을 잡은 채로 page fault가 나서 디스크를 읽거나,
+ * 읽어 들이는 도중에 버퍼 프레임이 쫓겨나는 일이 없어진다.
+ * 커널이 버퍼에 쓸 것이면 (WRITE) 커널 모드의 쓰기가 PTE의 쓰기 금지를 무시하므로,
+ * 고정하기 전에 vm_handle_wp로 COW 복사와 ELF 데이터 페이지(VM_PRIVATE)의 anon 전환을 끝낸다.
+ * 그렇지 않으면 실행 파일에서 다시 읽으면 되는 페이지로 남아 쫓겨날 때 쓴 내용이 버려진다.
+ * spt와 영역에 없는 주소 (앞으로 자랄 스택 등)는 건너뛰고 실제 접근 시의 폴트에 맡긴다.
+ * 로드에 실패하거나 쓸 버퍼에 read-only 페이지가 있으면 고정했던 페이지를 풀고 false */
+bool
+vm_pin_buffer (const void *uaddr, size_t size, bool write) {
+	struct thread *curr = thread_current ();
+	void *start = pg_round_down (uaddr);
+
+	for (void *va = start; va < uaddr + size; va += PGSIZE) {
+		struct page *page = spt_get_page (&curr->spt, va);
+		if (!page)
+			continue;
+		if (write && !page->writable) {
+			vm_unpin_buffer (start, va - start);
+			return false;
+		}
+		// claim과 pin 사이에 reclaim 데몬이 다시 쫓아낼 수 있으므로 반복.
+		// 프레임을 바꿀 수 있는 vm_handle_wp는 pin 하기 전에 불러야 고정이 옛 프레임에 남지 않는다
+		for (;;) {
+			if (!page->frame && !vm_do_claim_page (page)) {
+				vm_unpin_buffer (start, va - start);
+				return false;
+			}
+			if (write) {
+				uint64_t *pte = pml4e_walk (curr->pml4, (uint64_t) va, 0);
+				if (pte && !is_writable (pte) && !vm_handle_wp (page)) {
+					vm_unpin_buffer (start, va - start);
+					return false;
+				}
+			}
+			if (vm_pin_page (page))
+				break;
+		}
+	}
+	return true;
+}
+
+/* vm_pin_buffer로 고정한 버퍼를 푼다 */
+void
+vm_unpin_buffer (const void *uaddr, size_t size) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+
+	for (void *va = pg_round_down (uaddr); va < uaddr + size; va += PGSIZE) {
+		struct page *page = spt_find_page (spt, va);
+		if (page)
+			vm_unpin_page (page);
+	}
+}
+
+/* PAGE가 차지하던 프레임을 frame_table에서 빼고 물리 메모리를 반환한다.
+ * pml4_destroy가 같은 물리 페이지를 다시 해제하지 않도록 매핑도 지운다.
+ * 다른 프로세스와 공유 중인 프레임이면 PAGE만 떼어내고 프레임은 남겨둔다.
+ * 각 페이지 타입의 destroy에서 호출한다. writeback 데몬 등이 락 없이 I/O 중이면 끝날 때까지 기다린다.
+ * 그 사이 reclaim 데몬이 PAGE를 쫓아냈을 수 있으므로, 실제로 프레임을 갖고 있었는지 반환 */
+bool
+vm_free_frame (struct page *page) {
+	lock_acquire (&frame_lock);
+	// 락 없이 디스크 I/O 중인 프레임은 끝날 때까지 해제하지 않는다
+	while (page->frame && page->frame->in_io)
+		cond_wait (&frame_io_done, &frame_lock);
+	struct frame *frame = page->frame;
+
+	if (!frame) {
+		lock_release (&frame_lock);
+		return false;
+	}
+
+	if (page->owner->pml4)
+		pml4_clear_page (page->owner->pml4, page->va);
+	// zero 프레임은 마지막 페이지가 떠나도 해제하지 않는다
+	if (frame_unlink (page) > 0 || frame == &zero_frame) {
+		lock_release (&frame_lock);
+		return true;
+	}
+	text_frame_forget (frame);
+	frame_table_remove (frame);
+	lock_release (&frame_lock);
+
+	palloc_free_page (frame->kva);
+	free (frame);
+	return true;
+}
+
+/* 스왑 공간이 가득 찼을 때 anon_swap_out이 호출한다. frame_lock을 잡은 상태여야 함.
+ * 메모리에 올라와 있으면서 swap in 된 슬롯을 계속 붙들고 있는 anon 페이지들에게서
+ * 슬롯을 거둬 들인다. 그 페이지들은 다음에 쫓겨날 때 다시 써야 한다.
+ * 로드 중인 (pinned) 프레임은 swap_in이 슬롯을 읽고 있을 수 있으므로 건너뛴다.
+ * 하나라도 거뒀으면 true */
+bool
+vm_release_swap_slots (void) {
+	bool released = false;
+
+	ASSERT (lock_held_by_current_thread (&frame_lock));
+
+	for (struct list_elem *e = list_begin (&frame_table); e != list_end (&frame_table);
+			e = list_next (e)) {
+		struct frame *frame = list_entry (e, struct frame, frame_elem);
+		if (frame->pin_cnt > 0)
+			continue;
+		for (struct list_elem *p = list_begin (&frame->pages); p != list_end (&frame->pages);
+				p = list_next (p)) {
+			struct page *page = list_entry (p, struct page, frame_page_elem);
+			if (page_get_type (page) != VM_ANON || page->anon.slot == SWAP_SLOT_NONE)
+				continue;
+			anon_release_slot (page);
+			vm_stat.swap_slots_released++;
+			released = true;
+		}
+	}
+	return released;
+}
+
 /* Growing the stack. */
-static void
+static bool
 vm_stack_growth (void *addr UNUSED) {
 	// 하나 이상의 anon 페이지를 할당하여 스택 크기를 늘림
 	// addr은 faulted 주소에서 유효한 주소
 	addr = pg_round_down(addr);
-	if (vm_alloc_page(VM_ANON, addr, true))
-		thread_current()->stack_bottom -= PGSIZE;	// stack_bottom 갱신해줌
+	if (!vm_alloc_page(VM_ANON, addr, true))
+		return false;
+	thread_current()->stack_bottom -= PGSIZE;	// stack_bottom 갱신해줌
+	return true;
 }
 
-/* Handle the fault on write_protected page */
+/* PAGE가 아직 로드되지 않았고 파일에서 내용을 읽어오는 페이지 (ELF 세그먼트, mmap, 코드) 면
+ * 읽어올 파일의 inode와 오프셋을 구한다 */
 static bool
-vm_handle_wp (struct page *page UNUSED) {
+uninit_file_key (struct page *page, struct inode **inode, off_t *ofs) {
+	if (VM_TYPE (page->operations->type) != VM_UNINIT || !page->uninit.aux)
+		return false;
+
+	enum vm_type type = page->uninit.type;
+	if (type & (VM_TEXT | VM_PRIVATE)) {
+		struct lazy_load_aux_text *aux = page->uninit.aux;
+		*inode = aux->inode;
+		*ofs = aux->ofs;
+	} else if (VM_TYPE (type) == VM_FILE) {
+		struct lazy_load_aux_file *aux = page->uninit.aux;
+		*inode = file_get_inode (aux->file);
+		*ofs = aux->ofs;
+	} else {
+		struct lazy_load_aux *aux = page->uninit.aux;
+		*inode = file_get_inode (aux->file);
+		*ofs = aux->ofs;
+	}
+	return true;
+}
+
+/* VA에서 INODE의 OFS를 읽어 들이는 폴트를 처리한 뒤, 바로 뒤의 페이지들 중
+ * 같은 초기화 함수로 같은 파일의 이어지는 위치를 읽는 페이지를 최대 WINDOW - 1 개 미리 올린다.
+ * 빈 프레임이 넉넉할 때만 하므로 fault-around 때문에 다른 페이지가 쫓겨나지는 않는다. */
+static void
+vm_fault_around (struct supplemental_page_table *spt, void *va,
+		vm_initializer *init, struct inode *inode, off_t ofs, size_t window) {
+	for (size_t i = 1; i < window; i++) {
+		struct page *next = spt_get_page (spt, va + i * PGSIZE);
+		struct inode *next_inode;
+		off_t next_ofs;
+
+		if (!next || !uninit_file_key (next, &next_inode, &next_ofs)
+				|| next->uninit.init != init || next_inode != inode
+				|| next_ofs != ofs + (off_t) (i * PGSIZE))
+			break;
+		// RSS 한도에 닿은 프로세스는 미리 읽느라 자기 페이지를 내보내지 않는다
+		if (free_frame_cnt () <= vm_watermark_high || rss_over_limit (next->owner))
+			break;
+		if (!vm_do_claim_page (next))
+			break;
+		vm_stat.fault_around_pages++;
+	}
+}
+
+/* MADV_SEQUENTIAL 영역에서 폴트가 나면 그 뒤로 이만큼을 미리 읽고,
+ * 이만큼 이상 지나간 페이지는 먼저 쫓겨나도록 돌려 둔다 */
+#define SEQ_WINDOW 16
+
+/* MADV_SEQUENTIAL 영역 AREA에서 VA까지 읽었으면 SEQ_WINDOW ~ 2 * SEQ_WINDOW 페이지 전에
+ * 읽은 페이지는 다시 쓰이지 않을 것이므로, 다른 프로세스의 자주 쓰는 페이지 대신
+ * 이 페이지들이 먼저 쫓겨나게 한다. 바로 뒤쪽 창은 되돌아가 읽는 경우를 위해 남겨 둔다. */
+static void
+vm_drop_behind (struct supplemental_page_table *spt, struct vm_area *area,
+		void *va) {
+	if (va - area->start < SEQ_WINDOW * PGSIZE)
+		return;
+	void *end = va - SEQ_WINDOW * PGSIZE;
+	void *start = end - area->start > SEQ_WINDOW * PGSIZE
+		? end - SEQ_WINDOW * PGSIZE : area->start;
+
+	lock_acquire (&frame_lock);
+	for (void *p = start; p < end; p += PGSIZE) {
+		struct page *page = spt_find_page (spt, p);
+		struct frame *frame = page ? page->frame : NULL;
+
+		// 다른 프로세스와 공유 중이거나 고정된 프레임, zero 프레임은 그대로 둔다
+		if (!frame || frame == &zero_frame || frame->ref_cnt > 1 || frame->pin_cnt > 0)
+			continue;
+		frame_deactivate (frame);
+		vm_stat.seq_deactivated++;
+	}
+	lock_release (&frame_lock);
+}
+
+/* PAGE를 포함한 2MB 영역의 512개 페이지가 모두 spt나 영역에 있고, 아직 로드되지 않았고,
+ * 쓰기 권한이 같아서 2MB 페이지 하나로 매핑할 수 있는지 확인.
+ * 코드 페이지는 다른 프로세스와 4kB 단위로 공유하므로 제외하고, 데이터 세그먼트 (VM_PRIVATE)는
+ * 실행 파일에서 읽을 내용이 없는 .bss 부분만 허용한다 (이 부분은 anon 페이지로 만들어진다).
+ * 아직 만들어지지 않은 페이지는 영역만 확인하고 만들지는 않는다 */
+static bool
+large_page_eligible (struct supplemental_page_table *spt, struct page *page) {
+	void *base = large_pg_round_down (page->va);
+
+	for (size_t i = 0; i < LARGE_PGCNT; i++) {
+		struct page *p = spt_find_page (spt, base + i * PGSIZE);
+		if (!p) {
+			void *va = base + i * PGSIZE;
+			struct vm_area *area = vm_area_find (spt, va);
+			if (!area || area->writable != page->writable || (area->type & VM_TEXT))
+				return false;
+			if ((area->type & VM_PRIVATE) && (size_t) (va - area->start) < area->read_bytes)
+				return false;
+			continue;
+		}
+		if (p->frame || p->writable != page->writable
+				|| VM_TYPE (p->operations->type) != VM_UNINIT
+				|| (p->uninit.type & (VM_TEXT | VM_PRIVATE)))
+			return false;
+	}
+	return true;
+}
+
+/* -large-pages가 켜져 있고 PAGE를 포함한 2MB 영역 전체를 한 번에 올릴 수 있으면
+ * 물리적으로 연속되고 2MB 정렬된 프레임 512개를 받아 PDE 하나로 매핑한 뒤 모두 로드한다.
+ * 각 4kB 프레임은 평소처럼 frame_table에 들어가므로 eviction, COW, munmap 등
+ * 한 페이지만 건드리는 작업은 mmu.c에서 2MB 매핑을 쪼갠 뒤 기존 경로로 처리된다. */
+static bool
+vm_claim_large_page (struct page *page) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	uint64_t *pml4 = page->owner->pml4;
+	void *base = large_pg_round_down (page->va);
+
+	if (!vm_large_pages || !large_page_eligible (spt, page))
+		return false;
+	// 512개를 한꺼번에 올리면 RSS 한도를 넘는 프로세스는 4kB 경로로
+	if (page->owner->rss_limit != 0 && page->owner->rss + LARGE_PGCNT > page->owner->rss_limit)
+		return false;
+	for (size_t i = 0; i < LARGE_PGCNT; i++)
+		if (!spt_get_page (spt, base + i * PGSIZE))
+			return false;
+
+	void *kva = palloc_get_aligned (PAL_USER | PAL_ZERO, LARGE_PGCNT, LARGE_PGCNT);
+	if (!kva)
+		return false;
+
+	lock_acquire (&frame_lock);
+	for (size_t i = 0; i < LARGE_PGCNT; i++) {
+		struct frame *frame = malloc (sizeof *frame);
+		if (!frame)
+			PANIC ("vm_claim_large_page: out of kernel memory");
+		frame->kva = kva + i * PGSIZE;
+		frame_prepare (frame);
+		frame_link (frame, spt_find_page (spt, base + i * PGSIZE));
+	}
+	bool success = pml4_set_large_page (pml4, base, kva, page->writable);
+	reclaim_wakeup ();
+	lock_release (&frame_lock);
+
+	// 매핑에 실패하면 프레임을 하나씩 돌려주고 4kB 경로로 처리
+	if (!success) {
+		for (size_t i = 0; i < LARGE_PGCNT; i++)
+			vm_free_frame (spt_find_page (spt, base + i * PGSIZE));
+		return false;
+	}
+
+	size_t loaded = 0;
+	while (loaded < LARGE_PGCNT) {
+		struct page *p = spt_find_page (spt, base + loaded * PGSIZE);
+		if (!swap_in (p, p->frame->kva))
+			break;
+		loaded++;
+	}
+
+	// 로드에 실패하면 이미 로드한 페이지는 보통 프레임처럼 남기고 (pin만 푼다),
+	// 실패한 페이지부터 나머지 프레임은 매핑을 지우고 유저 풀에 돌려준다.
+	// 2MB 매핑은 pml4_clear_page가 4kB 매핑으로 쪼갠다
+	lock_acquire (&frame_lock);
+	for (size_t i = 0; i < loaded; i++)
+		spt_find_page (spt, base + i * PGSIZE)->frame->pin_cnt--;
+	lock_release (&frame_lock);
+	if (loaded < LARGE_PGCNT) {
+		for (size_t i = loaded; i < LARGE_PGCNT; i++)
+			vm_free_frame (spt_find_page (spt, base + i * PGSIZE));
+		return false;
+	}
+	vm_stat.large_page_maps++;
+	return true;
+}
+
+/* 아직 한 번도 로드되지 않은, init 없는 (내용이 전부 0인) anon 페이지를
+ * 공용 zero 프레임에 읽기 전용으로 매핑한다. 해당하지 않는 페이지면 false */
+static bool
+vm_claim_zero_page (struct page *page) {
+	if (VM_TYPE (page->operations->type) != VM_UNINIT
+			|| VM_TYPE (page->uninit.type) != VM_ANON
+			|| page->uninit.init != NULL)
+		return false;
+
+	lock_acquire (&frame_lock);
+	frame_link (&zero_frame, page);
+	bool success = pml4_set_page (page->owner->pml4, page->va, zero_frame.kva, false);
+	lock_release (&frame_lock);
+
+	// uninit -> anon 변환. init이 없으므로 프레임 내용은 건드리지 않는다
+	if (!success || !swap_in (page, zero_frame.kva))
+		return false;
+	vm_stat.zero_page_maps++;
+	return true;
+}
+
+/* Handle the fault on write_protected page
+ * fork 후 부모와 자식이 읽기 전용으로 공유하던 프레임에 처음 쓰는 경우.
+ * 아직 다른 페이지가 프레임을 공유하고 있으면 새 프레임에 내용을 복사해 옮기고,
+ * 혼자 남았으면 복사 없이 쓰기만 다시 허용한다.
+ * zero 프레임에 처음 쓰는 경우에는 항상 0으로 채워진 새 프레임을 받는다.
+ * 아직 쓰지 않은 ELF 데이터 페이지(VM_PRIVATE)는 이때 anon 페이지가 되어
+ * 이후로는 실행 파일 대신 스왑에 내용을 보관한다. */
+static bool
+vm_handle_wp (struct page *page) {
+	uint64_t *pml4 = page->owner->pml4;
+	struct inode *data_inode = NULL;
+	bool success = true;
+
+	lock_acquire (&frame_lock);
+	while (page->frame && page->frame->in_io)
+		cond_wait (&frame_io_done, &frame_lock);
+	struct frame *shared = page->frame;
+
+	// 폴트 이후 reclaim 데몬이 쫓아냈으면 다시 폴트가 나서 swap in 된다
+	if (!shared) {
+		lock_release (&frame_lock);
+		return true;
+	}
+
+	// 프레임을 잡고 있는 동안 바꿔야 eviction이 파일 페이지로 보고 버리지 않는다
+	if (page_is_private_file (page)) {
+		data_inode = page->file.inode;
+		anon_initializer (page, VM_ANON, shared->kva);
+		vm_stat.data_anon_pages++;
+	}
+
+	if (shared->ref_cnt == 1 && shared != &zero_frame)
+		pml4_set_writable (pml4, page->va, true);
+	else {
+		// eviction의 디스크 쓰기나 OOM으로 기다리는 동안 frame_lock을 놓을 수 있으므로, 다른 공유자가 종료해
+		// 혼자 남은 프레임이 그 사이 쫓겨나지 않도록 복사가 끝날 때까지 pin 한다
+		shared->pin_cnt++;
+		struct frame *frame = vm_get_frame (page->owner);
+		if (!frame)
+			success = false;
+		else {
+			if (shared != &zero_frame) {
+				memcpy (frame->kva, shared->kva, PGSIZE);
+				vm_stat.cow_faults++;
+			}
+			frame_unlink (page);
+			frame_link (frame, page);
+			frame->pin_cnt--;
+			success = pml4_set_page (pml4, page->va, frame->kva, true);
+		}
+		shared->pin_cnt--;
+	}
+	lock_release (&frame_lock);
+	// 데이터 페이지가 갖고 있던 실행 파일의 inode 참조 반환
+	if (data_inode)
+		inode_close (data_inode);
+	return success;
+}
+
+/* 커널이 유저 버퍼 [UADDR, UADDR + SIZE)에 직접 쓰기 전에 호출한다.
+ * 커널 모드의 쓰기는 PTE의 쓰기 금지를 무시하므로 (CR0.WP 꺼짐)
+ * COW로 공유 중인 프레임을 미리 복사해 두지 않으면 다른 프로세스의 메모리가 바뀐다.
+ * 버퍼에 read-only 페이지가 있으면 false 반환 */
+bool
+vm_prepare_write (void *uaddr, size_t size) {
+	struct thread *curr = thread_current ();
+
+	if (size == 0)
+		return true;
+
+	for (void *va = pg_round_down (uaddr); va < uaddr + size; va += PGSIZE) {
+		struct page *page = spt_get_page (&curr->spt, va);
+
+		// spt에 없는 주소는 실제 쓰기 시의 page fault(스택 증가 등)에 맡긴다
+		if (!page)
+			continue;
+		if (!page->writable)
+			return false;
+		if (page->frame) {
+			uint64_t *pte = pml4e_walk (curr->pml4, (uint64_t) va, 0);
+			if (pte && !is_writable (pte) && !vm_handle_wp (page))
+				return false;
+		}
+	}
+	return true;
+}
+
+/* madvise(MADV_WILLNEED): [START, END)에서 아직 올라와 있지 않고 파일이나 스왑에서
+ * 읽어야 하는 페이지를 미리 올린다. fault-around처럼 빈 프레임이 high watermark 위에
+ * 있는 동안만 하므로 미리 읽느라 다른 페이지를 쫓아내지는 않는다. */
+static void
+vm_advise_willneed (struct supplemental_page_table *spt, void *start, void *end) {
+	for (void *va = start; va < end; va += PGSIZE) {
+		if (free_frame_cnt () <= vm_watermark_high || rss_over_limit (thread_current ()))
+			break;
+		struct page *page = spt_find_page (spt, va);
+		if (!page && !vm_area_find (spt, va))
+			continue;
+		if (!page)
+			page = spt_get_page (spt, va);
+		// 처음 쓸 때 0으로 채워질 anon 페이지는 읽을 것이 없다
+		if (!page || page->frame || (VM_TYPE (page->operations->type) == VM_UNINIT
+					&& !page->uninit.init))
+			continue;
+		if (vm_do_claim_page (page))
+			vm_stat.madv_prefetched++;
+	}
+}
+
+/* madvise(MADV_DONTNEED): [START, END)의 페이지를 바로 파괴해 프레임과 스왑 슬롯을 돌려준다.
+ * dirty mmap 페이지는 파괴되면서 파일에 쓰인다. 영역 안의 페이지는 다음 폴트 때 영역에서
+ * 다시 만들어지고 (파일 내용이나 0), 영역 밖의 페이지 (스택)는 0으로 채워질 anon 페이지로 바뀐다. */
+static void
+vm_advise_dontneed (struct supplemental_page_table *spt, void *start, void *end) {
+	struct page *page;
+
+	while ((page = spt_find_range (spt, start, end)) != NULL) {
+		void *va = page->va;
+		bool writable = page->writable;
+
+		start = va + PGSIZE;
+		spt_remove_page (spt, page);
+		if (!vm_area_find (spt, va) && !vm_alloc_page (VM_ANON, va, writable))
+			PANIC ("vm_advise_dontneed: out of kernel memory");
+		vm_stat.madv_dropped++;
+	}
+}
+
+/* madvise 시스템 콜. [ADDR, ADDR + LENGTH)의 접근 패턴을 ADVICE로 알려 준다.
+ * MADV_NORMAL, MADV_SEQUENTIAL은 범위 안의 영역 (ELF 세그먼트, mmap)에 적용된다.
+ * 알 수 없는 ADVICE면 -1 */
+int
+vm_madvise (void *addr, size_t length, int advice) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up (addr + length);
+	struct list_elem *e;
+
+	switch (advice) {
+		case MADV_NORMAL:
+		case MADV_SEQUENTIAL:
+			// 범위에 일부만 걸친 영역은 쪼갠다. 쪼개진 위쪽 영역은 바로 다음 원소로 들어간다
+			for (e = list_begin (&spt->areas); e != list_end (&spt->areas); e = list_next (e)) {
+				struct vm_area *area = list_entry (e, struct vm_area, elem);
+				if (area->end <= addr || end <= area->start)
+					continue;
+				if (area->start < addr) {
+					if (!vm_area_split (spt, area, addr))
+						return -1;
+					continue;
+				}
+				if (end < area->end && !vm_area_split (spt, area, end))
+					return -1;
+				area->advice = advice;
+			}
+			return 0;
+		case MADV_WILLNEED:
+			vm_advise_willneed (spt, addr, end);
+			return 0;
+		case MADV_DONTNEED:
+			vm_advise_dontneed (spt, addr, end);
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+/* mprotect 시스템 콜. [ADDR, ADDR + LENGTH)의 쓰기 권한을 WRITABLE로 바꾼다.
+ * 범위 전체가 영역으로 덮여 있어야 하고, 영역의 일부만 걸치면 영역을 쪼갠다.
+ * 코드 영역은 다른 프로세스와 프레임을 공유하므로 쓰기 가능하게 바꿀 수 없다.
+ * 쓰기 가능하게 바꾼 페이지는 PTE를 그대로 두고, 처음 쓸 때 vm_handle_wp가
+ * (COW나 zero 프레임이면 복사한 뒤) PTE를 쓰기 가능하게 바꾼다. */
+int
+vm_mprotect (void *addr, size_t length, bool writable) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = pg_round_up (addr + length);
+	struct vm_area *area;
+	void *va;
+
+	for (va = addr; va < end; va = area->end) {
+		area = vm_area_find (spt, va);
+		if (!area || (writable && (area->type & VM_TEXT)))
+			return -1;
+	}
+
+	for (va = addr; va < end; va = area->end) {
+		area = vm_area_find (spt, va);
+		if (area->start < va && !(area = vm_area_split (spt, area, va)))
+			return -1;
+		if (end < area->end && !vm_area_split (spt, area, end))
+			return -1;
+		area->writable = writable;
+	}
+
+	lock_acquire (&frame_lock);
+	for (struct page *page = spt_find_range (spt, addr, end); page;
+			page = spt_find_range (spt, page->va + PGSIZE, end)) {
+		page->writable = writable;
+		if (!writable && page->frame)
+			pml4_set_writable (page->owner->pml4, page->va, false);
+	}
+	lock_release (&frame_lock);
+	return 0;
+}
+
+/* 아직 메모리에 없는 PAGE의 폴트를 처리하면 내용을 어디서 가져오게 되는지로 분류한다.
+ * 다른 프로세스가 이미 올려 둔 코드 프레임을 공유하게 되면 디스크를 읽지 않으므로 minor */
+static enum vm_fault_class
+fault_class (struct page *page) {
+	struct inode *inode;
+	off_t ofs;
+
+	if (text_page_key (page, &inode, &ofs)) {
+		lock_acquire (&frame_lock);
+		bool shared = text_frame_find (inode, ofs) != NULL;
+		lock_release (&frame_lock);
+		return shared ? VM_FAULT_MINOR : VM_FAULT_MAJOR_FILE;
+	}
+	if (VM_TYPE (page->operations->type) == VM_UNINIT)
+		return page->uninit.init && page->uninit.aux ? VM_FAULT_MAJOR_FILE : VM_FAULT_MINOR;
+	return page_get_type (page) == VM_ANON ? VM_FAULT_MAJOR_SWAP : VM_FAULT_MAJOR_FILE;
+}
+
+/* 폴트 하나를 CLASS로 세고, 처리에 걸린 CYCLES를 log2 히스토그램에 더한다 */
+static void
+fault_account (enum vm_fault_class class, uint64_t cycles) {
+	int bucket = 0;
+
+	while (cycles >>= 1)
+		bucket++;
+	if (bucket >= VM_FAULT_HIST_BUCKETS)
+		bucket = VM_FAULT_HIST_BUCKETS - 1;
+
+	vm_fault_stat.cnt[class]++;
+	vm_fault_stat.hist[class][bucket]++;
+	thread_current ()->fault_cnt[class]++;
 }
 
 /* Return true on success
@@ -215,24 +1758,29 @@ vm_handle_wp (struct page *page UNUSED) {
  * user: rsp값이 VM이 유저/커널 영역중 어디인지. 해당 값이 true일 경우 유저모드에서 페폴 일으켰다는 뜻 
  * write: true일 경우 해당 페폴이 쓰기 요청이고 그렇지 않을 경우 읽기 요청
  * non-present: 해당 인자가 false인 겨우 read-only 페이지에 write 하려는 상황 */
-bool
-vm_try_handle_fault (struct intr_frame *f, void *addr,
-		bool user, bool write, bool not_present) {
+static bool
+vm_handle_fault (struct intr_frame *f, void *addr,
+		bool user, bool write, bool not_present, enum vm_fault_class *class) {
 		
 	struct thread *curr = thread_current();
 	struct supplemental_page_table *spt = &thread_current()->spt;
 	
+	bool grew = false;
+
+	// 처리하지 못하고 false를 반환하는 경로는 모두 invalid
+	*class = VM_FAULT_INVALID;
+
 	// 페이지 폴트가 발생한 가상 주소 및 인자들이 유효한지 체크
 	if (!is_user_vaddr(addr))
 		return false;
 	// 스택 증가로 page fault 예외를 처리할 수 있는지 확인 후 vm_stack_growth 호출
 	// rsp가 유효하면 스택그로우 호출
 	if (USER_STACK - (1<<20) <= addr && curr->rsp_stack-8 <= addr && addr <= curr->stack_bottom)
-		vm_stack_growth(addr);
+		grew = vm_stack_growth(addr);
 
 	// 접근한 메모리가 물리 페이지와 매핑 되지 않은 경우
 	if (not_present) { 
-		struct page *page = spt_find_page(spt, addr);
+		struct page *page = spt_get_page(spt, addr);
 		if (!page)
 			return false;
 			
@@ -240,11 +1788,77 @@ vm_try_handle_fault (struct intr_frame *f, void *addr,
 		if (write && !page->writable)
 			return false;
 
-		return vm_do_claim_page (page);
+		// 쫓겨나는 중이라 매핑만 끊긴 페이지면 쓰기가 끝난 뒤 다시 접근해서 읽어 오게 한다
+		if (vm_wait_io (page)) {
+			*class = VM_FAULT_MINOR;
+			return true;
+		}
+
+		enum vm_fault_class page_class = grew ? VM_FAULT_STACK : fault_class (page);
+
+		// 0으로 채워질 anon 페이지를 읽기만 하면 프레임을 할당하지 않고 zero 프레임을 매핑
+		if (!write && vm_claim_zero_page (page)) {
+			*class = page_class;
+			return true;
+		}
+
+		// 정렬된 2MB 영역이 통째로 비어 있으면 2MB 페이지로 매핑
+		if (vm_claim_large_page (page)) {
+			*class = page_class;
+			return true;
+		}
+
+		// 한 번 초기화된 페이지가 다시 폴트 -> 스왑/파일에서 읽어와야 하는 major fault
+		if (VM_TYPE (page->operations->type) != VM_UNINIT)
+			vm_stat.major_faults++;
+
+		// claim이 aux를 해제하므로 fault-around에 쓸 파일 위치를 먼저 기억
+		struct inode *inode;
+		off_t ofs;
+		bool from_file = uninit_file_key (page, &inode, &ofs);
+		vm_initializer *init = from_file ? page->uninit.init : NULL;
+		struct vm_area *area = vm_area_find (spt, page->va);
+		bool sequential = area && area->advice == MADV_SEQUENTIAL;
+
+		if (!vm_do_claim_page (page))
+			return false;
+		// 데이터 페이지에 쓰려고 들어왔으면 바로 anon으로 바꿔 쓰기를 허용
+		if (write && page_is_private_file (page) && !vm_handle_wp (page))
+			return false;
+		if (from_file)
+			vm_fault_around (spt, page->va, init, inode, ofs,
+					sequential && vm_fault_around_pages < SEQ_WINDOW
+					? SEQ_WINDOW : vm_fault_around_pages);
+		if (sequential)
+			vm_drop_behind (spt, area, page->va);
+		*class = page_class;
+		return true;
+	}
+
+	// 존재하는 페이지에 대한 쓰기 폴트: COW로 읽기 전용 매핑된 페이지인지 확인.
+	// 폴트 이후 페이지가 쫓겨났을 수 있으므로 프레임 유무는 vm_handle_wp가 frame_lock을 잡고 확인한다
+	if (write) {
+		struct page *page = spt_find_page(spt, addr);
+		if (!page || !page->writable || !vm_handle_wp (page))
+			return false;
+		*class = VM_FAULT_WP;
+		return true;
 	}
 	return false;
 }
 
+/* 폴트를 처리하면서 분류와 처리 시간 (TSC)을 기록한다. 결과는 vm_print_stats가 출력 */
+bool
+vm_try_handle_fault (struct intr_frame *f, void *addr,
+		bool user, bool write, bool not_present) {
+	enum vm_fault_class class;
+	uint64_t start = rdtsc ();
+	bool success = vm_handle_fault (f, addr, user, write, not_present, &class);
+
+	fault_account (class, rdtsc () - start);
+	return success;
+}
+
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
 void
@@ -275,92 +1889,201 @@ vm_do_claim_page (struct page *page) {
 	// 페이지가 유효하지 않거나, 페이지가 이미 차지된 경우
 	if (!page || page->frame)
 		return false;
+
+	// 같은 실행 파일의 코드 페이지가 이미 올라와 있으면 읽지 않고 그 프레임을 공유
+	struct inode *text_inode;
+	off_t text_ofs;
+	bool is_text = text_page_key (page, &text_inode, &text_ofs);
+	// 쓰지 않은 데이터 페이지는 첫 쓰기를 잡기 위해 읽기 전용으로 매핑
+	bool writable = page->writable && !page_is_private_file (page);
+
+	lock_acquire (&frame_lock);
+	if (swap_out_writers > 0)
+		vm_stat.swap_out_overlaps++;
+	if (is_text) {
+		struct frame *shared = text_frame_find (text_inode, text_ofs);
+		if (shared) {
+			frame_link (shared, page);
+			bool success = pml4_set_page(page->owner->pml4, page->va, shared->kva, false);
+			lock_release (&frame_lock);
+			if (!success)
+				return false;
+			if (VM_TYPE (page->operations->type) == VM_UNINIT)
+				file_text_attach (page);
+			vm_stat.text_shares++;
+			return true;
+		}
+	}
 	
-	struct frame *frame = vm_get_frame ();	// 새 프레임 할당
-	struct thread *curr = thread_current();
+	struct frame *frame = vm_get_frame (page->owner);	// 새 프레임 할당 (pinned)
+	if (!frame) {
+		lock_release (&frame_lock);
+		return false;
+	}
 
 	/* Set links */
-	frame->page = page;
-	page->frame = frame;
+	frame_link (frame, page);
+	lock_release (&frame_lock);
 	/* frame과 page 연결.
-	 * 페이지의 va를 프레임의 pa에 매핑하고 페이지 테이블에 추가 */
-	if (!pml4_set_page(curr->pml4, page->va, frame->kva, page->writable)) {
+	 * 페이지의 va를 프레임의 pa에 매핑하고 페이지 테이블에 추가
+	 * fork 중에는 부모의 페이지를 올릴 수도 있으므로 owner의 pml4 사용 */
+	if (!pml4_set_page(page->owner->pml4, page->va, frame->kva, writable)) {
 		return false;
 	}
-	return swap_in (page, frame->kva);
-}
-
-/* Returns a hash value for page p. */
-unsigned
-page_hash (const struct hash_elem *p_, void *aux UNUSED) {
-  const struct page *p = hash_entry (p_, struct page, hash_elem);
-  return hash_bytes (&p->va, sizeof p->va);
-}
-
-/* Returns true if page a precedes page b. */
-bool
-page_less (const struct hash_elem *a_,
-           const struct hash_elem *b_, void *aux UNUSED) {
-  const struct page *a = hash_entry (a_, struct page, hash_elem);
-  const struct page *b = hash_entry (b_, struct page, hash_elem);
+	// 디스크 I/O 동안은 frame_lock을 놓는다. 프레임이 pinned라 쫓겨나지 않음
+	if (!swap_in (page, frame->kva))
+		return false;
 
-  return a->va < b->va;
+	lock_acquire (&frame_lock);
+	// 다음 프로세스가 찾을 수 있도록 코드 프레임 등록
+	if (is_text) {
+		frame->text_inode = text_inode;
+		frame->text_ofs = text_ofs;
+		// 다른 프로세스가 동시에 같은 페이지를 먼저 등록했으면 이 프레임은 혼자 씀
+		if (hash_insert (&text_frames, &frame->text_elem))
+			frame->text_inode = NULL;
+	}
+	frame->pin_cnt--;
+	lock_release (&frame_lock);
+	return true;
 }
 
 /* Initialize new supplemental page table */
 void
-supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
-	hash_init (&spt->hash_table, page_hash, page_less, NULL);
+supplemental_page_table_init (struct supplemental_page_table *spt) {
+	spt->root = NULL;
+	list_init (&spt->areas);
 }
 
 /* Copy supplemental page table from src to dst
- * src의 spt를 dst의 spt로 복사 */
+ * src의 spt를 dst의 spt로 복사
+ * 이미 초기화된 페이지는 내용을 복사하지 않고 부모의 프레임을 자식과 공유한다 (copy-on-write).
+ * 양쪽 모두 읽기 전용으로 매핑해 두고, 먼저 쓰는 쪽이 vm_handle_wp에서 복사본을 만든다. */
 bool
-supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED,
-	struct supplemental_page_table *src UNUSED) {
+supplemental_page_table_copy (struct supplemental_page_table *dst,
+	struct supplemental_page_table *src) {
 
-	struct hash_iterator src_iter;
-
-	// hash_apply()
-	hash_first(&src_iter, &src->hash_table);
+	// ELF 세그먼트와 mmap 영역을 먼저 복사. 영역 안에서 아직 로드되지 않은 페이지와
+	// 코드 페이지는 자식이 폴트 시 자기 영역에서 다시 만든다
+	if (!vm_area_copy(dst, src))
+		return false;
 
-	while (hash_next(&src_iter)) {
-		struct page *src_page = hash_entry(hash_cur(&src_iter), struct page, hash_elem);
+	// 주소 순서대로 부모의 페이지를 하나씩 복사
+	for (struct page *src_page = spt_find_range(src, 0, (void *) KERN_BASE); src_page;
+			src_page = spt_find_range(src, src_page->va + PGSIZE, (void *) KERN_BASE)) {
 		
 		enum vm_type type= src_page->operations->type;
 		void *upage = src_page->va;
 		bool writable = src_page->writable;
 		
+		// 코드 페이지는 자식이 폴트 시 영역에서 같은 (inode, offset)의 VM_TEXT 페이지를 만들어
+		// text_frames에서 부모의 프레임을 찾아 공유한다
+		struct inode *text_inode;
+		off_t text_ofs;
+		if ((type == VM_UNINIT || text_page_key(src_page, &text_inode, &text_ofs))
+				&& vm_area_find(src, upage))
+			continue;
+
 		if (type == VM_UNINIT) {
-			vm_alloc_page_with_initializer(VM_ANON, upage, writable, src_page->uninit.init, src_page->uninit.aux);
+			// lazy_load_file은 로드 후 aux를 free 하므로 자식은 자기 aux를 가져야 한다
+			void *aux = src_page->uninit.aux;
+			if (aux) {
+				size_t aux_size = VM_TYPE (src_page->uninit.type) == VM_FILE
+					? sizeof (struct lazy_load_aux_file) : sizeof (struct lazy_load_aux);
+				aux = malloc(aux_size);
+				if (!aux)
+					return false;
+				memcpy(aux, src_page->uninit.aux, aux_size);
+			}
+			if (!vm_alloc_page_with_initializer(VM_ANON, upage, writable, src_page->uninit.init, aux)) {
+				free(aux);
+				return false;
+			}
 			continue;	
 		}
-		
+
 		// 자식에게 새 페이지를 할당
 		// 어차피 ANON으로 만들어주니까 init, aux NULL, NULL
 		if (!vm_alloc_page(VM_ANON, upage, writable))
 			return false;
-		
-		if (!vm_claim_page(upage))
-			return false;
 
 		struct page *dst_page = spt_find_page(dst, upage);
 
-		// 페이지 정보 복사
-		if(src_page->frame)
-			memcpy(dst_page->frame->kva, src_page->frame->kva, PGSIZE);
+		// 쫓겨나는 중인 프레임은 쓰기가 끝나야 공유할 수 있다.
+		// 스왑 아웃된 anon 페이지가 아닌 부모 페이지는 먼저 메모리에 올려야 공유할 수 있음.
+		// claim과 lock 사이에 reclaim 데몬이 다시 쫓아낼 수 있으므로 반복
+		lock_acquire(&frame_lock);
+		for (;;) {
+			while (src_page->frame && src_page->frame->in_io)
+				cond_wait(&frame_io_done, &frame_lock);
+			if (src_page->frame || (page_get_type(src_page) == VM_ANON
+						&& src_page->anon.slot != SWAP_SLOT_NONE))
+				break;
+			lock_release(&frame_lock);
+			if (!vm_do_claim_page(src_page))
+				return false;
+			lock_acquire(&frame_lock);
+		}
+
+		// 스왑 아웃된 anon 페이지는 메모리에 올리지 않고 스왑 슬롯을 자식과 공유한다
+		if (!src_page->frame) {
+			anon_initializer(dst_page, VM_ANON, NULL);
+			anon_share_slot(dst_page, src_page);
+			lock_release(&frame_lock);
+			continue;
+		}
+		struct frame *frame = src_page->frame;
+
+		// 새 프레임을 받는 대신 부모의 프레임에 바로 anon 페이지로 올린다
+		anon_initializer(dst_page, VM_ANON, frame->kva);
+		bool mapped = pml4_set_page(dst_page->owner->pml4, upage, frame->kva, false);
+		if (mapped) {
+			frame_link(frame, dst_page);
+			// 부모도 읽기 전용으로 바꾼다 (dirty bit는 munmap 시 write back을 위해 유지)
+			if (writable)
+				pml4_set_writable(src_page->owner->pml4, upage, false);
+		}
+		lock_release(&frame_lock);
+		if (!mapped)
+			return false;
 	}
 	return true;
 }
 
-void
-hash_bye (struct hash_elem *e, void *aux) {
-	struct page *page = hash_entry(e, struct page, hash_elem);
-	destroy(page);
+/* LEVEL 단계 노드 아래의 모든 페이지를 슬롯에서 빼고 파괴한다 */
+static void
+spt_destroy_pages (void **node, int level) {
+	for (int i = 0; i < 512; i++) {
+		if (!node[i])
+			continue;
+		if (level == SPT_LEVELS - 1) {
+			struct page *page = node[i];
+			node[i] = NULL;
+			vm_dealloc_page (page);
+		} else
+			spt_destroy_pages (node[i], level + 1);
+	}
 }
 
-/* Free the resource hold by the supplemental page table */
+/* LEVEL 단계 노드와 그 아래 노드들을 커널 풀에 돌려준다 */
+static void
+spt_free_nodes (void **node, int level) {
+	if (level < SPT_LEVELS - 1)
+		for (int i = 0; i < 512; i++)
+			if (node[i])
+				spt_free_nodes (node[i], level + 1);
+	palloc_free_page (node);
+}
+
+/* Free the resource hold by the supplemental page table
+ * 페이지를 모두 파괴한 뒤에 노드를 해제한다. exec 뒤에 다시 쓸 수 있도록 빈 트리로 남긴다.
+ * (다른 스레드의 eviction이 이웃 페이지를 조회할 수 있으므로 페이지가 남아 있는 동안은 노드를 유지) */
 void
 supplemental_page_table_kill (struct supplemental_page_table *spt) {
-	hash_clear(&spt->hash_table, hash_bye);
+	if (spt->root) {
+		spt_destroy_pages (spt->root, 0);
+		spt_free_nodes (spt->root, 0);
+		spt->root = NULL;
+	}
+	vm_area_kill (spt);
 }
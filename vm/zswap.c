@@ -0,0 +1,264 @@
+/* zswap.c: 스왑 디스크 앞에 두는 압축 페이지 풀.
+ * 쫓겨나는 anon 페이지를 LZ 방식으로 압축해 커널 메모리에 두고, 풀이 넘칠 때만
+ * 오래된 것부터 풀어서 스왑 디스크에 쓴다. 0이 대부분이거나 반복이 많은 페이지는
+ * 수십 바이트로 줄어들어 디스크 I/O 없이 swap out/in 된다. */
+
+#include "vm/zswap.h"
+#include <debug.h>
+#include <string.h>
+#include "lib/kernel/hash.h"
+#include "lib/kernel/list.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "vm/vm.h"
+
+/* 압축 결과가 이보다 크면 풀에 넣지 않고 바로 디스크에 쓴다 */
+#define ZSWAP_MAX_LEN (PGSIZE * 3 / 4)
+
+/* 압축 형식 (LZF와 같은 구조). 제어 바이트 C의 상위 3비트가
+ *   0이면 뒤따르는 C + 1 (1 ~ 32) 바이트가 리터럴,
+ *   L (1 ~ 6)이면 길이 L + 2, 7이면 다음 바이트 + 9 인 역참조이고,
+ *   C의 하위 5비트와 다음 바이트가 13비트 거리 - 1.
+ * 역참조는 겹칠 수 있어서 (거리 1) 같은 바이트가 이어지는 페이지는 3바이트에 264바이트씩 줄어든다. */
+#define LZ_MAX_LIT 32
+#define LZ_MAX_REF (7 + 255 + 2)
+#define LZ_MAX_OFF (1 << 13)
+#define LZ_HASH_BITS 12
+
+struct zswap_entry {
+	swap_slot_t slot;
+	size_t len;                   /* 압축된 길이 */
+	uint8_t *data;                /* malloc으로 받은 압축 데이터 */
+	struct hash_elem hash_elem;   /* zswap_table */
+	struct list_elem list_elem;   /* zswap_lru, 오래된 것부터 */
+};
+
+size_t zswap_max_pages = ZSWAP_AUTO;
+
+static struct hash zswap_table;
+static struct list zswap_lru;
+static size_t zswap_bytes;        /* 압축 데이터와 항목이 차지하는 바이트 수 */
+
+/* 압축용 작업 공간. swap_lock 아래에서만 쓰므로 하나면 충분하다 */
+static uint8_t zbuf[ZSWAP_MAX_LEN];
+static uint16_t lz_htab[1 << LZ_HASH_BITS];
+
+static uint64_t
+zswap_hash (const struct hash_elem *e, void *aux UNUSED) {
+	return hash_int (hash_entry (e, struct zswap_entry, hash_elem)->slot);
+}
+
+static bool
+zswap_less (const struct hash_elem *a, const struct hash_elem *b,
+		void *aux UNUSED) {
+	return hash_entry (a, struct zswap_entry, hash_elem)->slot
+		< hash_entry (b, struct zswap_entry, hash_elem)->slot;
+}
+
+void
+zswap_init (void) {
+	hash_init (&zswap_table, zswap_hash, zswap_less, NULL);
+	list_init (&zswap_lru);
+	if (zswap_max_pages == ZSWAP_AUTO)
+		zswap_max_pages = palloc_user_page_cnt () / 16;
+}
+
+static unsigned
+lz_hash (const uint8_t *p) {
+	uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* OUT에 IN[START, END)를 리터럴로 쓴다. OUT_MAX를 넘으면 false */
+static bool
+lz_emit_literals (const uint8_t *in, size_t start, size_t end,
+		uint8_t *out, size_t *op, size_t out_max) {
+	while (start < end) {
+		size_t n = end - start < LZ_MAX_LIT ? end - start : LZ_MAX_LIT;
+		if (*op + 1 + n > out_max)
+			return false;
+		out[(*op)++] = n - 1;
+		memcpy (out + *op, in + start, n);
+		*op += n;
+		start += n;
+	}
+	return true;
+}
+
+/* 페이지 IN을 OUT에 압축해 길이를 반환한다. OUT_MAX 안에 들어가지 않으면 0 */
+static size_t
+lz_compress (const uint8_t *in, uint8_t *out, size_t out_max) {
+	size_t ip = 0, op = 0, lit = 0;
+
+	memset (lz_htab, 0, sizeof lz_htab);
+	while (ip + 2 < PGSIZE) {
+		unsigned h = lz_hash (in + ip);
+		size_t ref = lz_htab[h];	// 위치 + 1, 0이면 없음
+		lz_htab[h] = ip + 1;
+
+		if (ref == 0 || ip - ref >= LZ_MAX_OFF
+				|| memcmp (in + ref - 1, in + ip, 3) != 0) {
+			ip++;
+			continue;
+		}
+		ref--;
+
+		size_t max = PGSIZE - ip < LZ_MAX_REF ? PGSIZE - ip : LZ_MAX_REF;
+		size_t len = 3;
+		while (len < max && in[ref + len] == in[ip + len])
+			len++;
+
+		if (!lz_emit_literals (in, lit, ip, out, &op, out_max) || op + 3 > out_max)
+			return 0;
+		size_t off = ip - ref - 1;
+		size_t l = len - 2;
+		if (l < 7)
+			out[op++] = (l << 5) | (off >> 8);
+		else {
+			out[op++] = (7 << 5) | (off >> 8);
+			out[op++] = l - 7;
+		}
+		out[op++] = off & 0xff;
+		ip += len;
+		lit = ip;
+	}
+	if (!lz_emit_literals (in, lit, PGSIZE, out, &op, out_max))
+		return 0;
+	return op;
+}
+
+/* IN[0..LEN)을 페이지 OUT으로 푼다. 형식이 깨졌으면 false */
+static bool
+lz_decompress (const uint8_t *in, size_t len, uint8_t *out) {
+	size_t ip = 0, op = 0;
+
+	while (ip < len) {
+		unsigned ctrl = in[ip++];
+
+		if (ctrl < LZ_MAX_LIT) {
+			size_t n = ctrl + 1;
+			if (ip + n > len || op + n > PGSIZE)
+				return false;
+			memcpy (out + op, in + ip, n);
+			ip += n;
+			op += n;
+			continue;
+		}
+
+		size_t l = ctrl >> 5;
+		if (l == 7) {
+			if (ip >= len)
+				return false;
+			l += in[ip++];
+		}
+		if (ip >= len)
+			return false;
+		size_t off = ((ctrl & 0x1f) << 8) + in[ip++] + 1;
+		size_t n = l + 2;
+		if (off > op || op + n > PGSIZE)
+			return false;
+		// 겹치는 역참조를 위해 한 바이트씩 복사
+		for (size_t i = 0; i < n; i++, op++)
+			out[op] = out[op - off];
+	}
+	return op == PGSIZE;
+}
+
+static struct zswap_entry *
+zswap_find (swap_slot_t slot) {
+	struct zswap_entry key;
+	struct hash_elem *e;
+
+	key.slot = slot;
+	e = hash_find (&zswap_table, &key.hash_elem);
+	return e ? hash_entry (e, struct zswap_entry, hash_elem) : NULL;
+}
+
+static void
+zswap_drop (struct zswap_entry *entry) {
+	hash_delete (&zswap_table, &entry->hash_elem);
+	list_remove (&entry->list_elem);
+	zswap_bytes -= entry->len + sizeof *entry;
+	free (entry->data);
+	free (entry);
+}
+
+/* 페이지 KVA를 압축해 SLOT의 내용으로 풀에 넣는다.
+ * 압축이 잘 안 되거나 메모리가 없으면 false이고, 호출자가 디스크에 써야 한다.
+ * 풀이 한도를 넘었는지는 호출자가 zswap_spill로 확인한다. */
+bool
+zswap_store (swap_slot_t slot, const void *kva) {
+	zswap_invalidate (slot);
+	if (zswap_max_pages == 0)
+		return false;
+
+	size_t len = lz_compress (kva, zbuf, sizeof zbuf);
+	if (len == 0) {
+		vm_stat.zswap_rejects++;
+		return false;
+	}
+
+	struct zswap_entry *entry = malloc (sizeof *entry);
+	uint8_t *data = malloc (len);
+	if (!entry || !data) {
+		free (entry);
+		free (data);
+		return false;
+	}
+	memcpy (data, zbuf, len);
+	entry->slot = slot;
+	entry->len = len;
+	entry->data = data;
+	hash_insert (&zswap_table, &entry->hash_elem);
+	list_push_back (&zswap_lru, &entry->list_elem);
+	zswap_bytes += len + sizeof *entry;
+	vm_stat.zswap_stores++;
+	return true;
+}
+
+/* SLOT이 풀에 있으면 페이지 KVA로 풀고 true. DROP이면 풀에서도 뺀다
+ * (fork로 슬롯을 공유하는 다른 페이지가 남아 있으면 호출자가 DROP을 false로 준다) */
+bool
+zswap_load (swap_slot_t slot, void *kva, bool drop) {
+	struct zswap_entry *entry = zswap_find (slot);
+
+	if (!entry)
+		return false;
+	if (!lz_decompress (entry->data, entry->len, kva))
+		PANIC ("zswap: corrupted compressed page for swap slot %u", slot);
+	if (drop)
+		zswap_drop (entry);
+	vm_stat.zswap_loads++;
+	return true;
+}
+
+bool
+zswap_contains (swap_slot_t slot) {
+	return zswap_find (slot) != NULL;
+}
+
+/* SLOT이 해제되거나 디스크에 새로 쓰여서 풀의 내용이 더 이상 맞지 않을 때 */
+void
+zswap_invalidate (swap_slot_t slot) {
+	struct zswap_entry *entry = zswap_find (slot);
+	if (entry)
+		zswap_drop (entry);
+}
+
+/* 풀이 한도를 넘었으면 가장 오래된 압축 페이지를 페이지 KVA로 풀어 풀에서 빼고,
+ * 그 슬롯을 *SLOT에 담아 true. 호출자가 KVA를 그 슬롯에 디스크로 써야 한다. */
+bool
+zswap_spill (swap_slot_t *slot, void *kva) {
+	if (zswap_bytes <= zswap_max_pages * PGSIZE || list_empty (&zswap_lru))
+		return false;
+
+	struct zswap_entry *entry = list_entry (list_front (&zswap_lru),
+			struct zswap_entry, list_elem);
+	if (!lz_decompress (entry->data, entry->len, kva))
+		PANIC ("zswap: corrupted compressed page for swap slot %u", entry->slot);
+	*slot = entry->slot;
+	zswap_drop (entry);
+	vm_stat.zswap_spills++;
+	return true;
+}